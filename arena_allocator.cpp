@@ -0,0 +1,301 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : arena_allocator.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Allocateur par blocs (arène) pour les noeuds de l'arbre binaire
+               de recherche.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Les objets sont découpés dans de grands blocs contigus. Les
+               emplacements libérés sont réutilisés et toute la mémoire est
+               rendue en une fois à la destruction de l'arène.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef ARENA_ALLOCATOR_CPP
+#define ARENA_ALLOCATOR_CPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ *  @brief Réserve d'emplacements de taille fixe.
+ *
+ *  La taille des emplacements est celle du premier type alloué (voir
+ *  adopt). Les emplacements sont pris séquentiellement dans le bloc
+ *  courant. Un emplacement libéré est chainé dans une liste libre et
+ *  réutilisé en priorité.
+ */
+class NodeArena
+{
+    struct FreeSlot
+    {
+        FreeSlot *next; // emplacement suivant de la liste libre
+    };
+
+    std::vector<char *> blocks; // blocs alloués, rendus à la destruction
+    char *cur;                  // prochain emplacement libre du bloc courant
+    char *end;                  // fin du bloc courant
+    FreeSlot *freeList;         // emplacements rendus par deallocate
+    size_t slotSize;            // 0 tant qu'aucun type n'a été adopté
+    size_t slotAlign;
+    size_t nextBlock;           // nombre d'emplacements du prochain bloc
+
+public:
+    NodeArena() noexcept
+            : cur(nullptr), end(nullptr), freeList(nullptr), slotSize(0), slotAlign(0),
+              nextBlock(64)
+    {
+    }
+
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    ~NodeArena()
+    {
+        release();
+    }
+
+    /**
+     * @brief Indique si un objet U tient dans un emplacement
+     */
+    template <typename U>
+    bool fits() const noexcept
+    {
+        return sizeof(U) <= slotSize && alignof(U) <= slotAlign;
+    }
+
+    /**
+     * @brief Fixe la taille des emplacements à celle de U, si aucun type
+     *        n'a encore été adopté
+     *
+     * @return fits<U>()
+     */
+    template <typename U>
+    bool adopt() noexcept
+    {
+        if (slotSize == 0 && alignof(U) <= alignof(std::max_align_t))
+        {
+            slotAlign = std::max(alignof(U), alignof(FreeSlot));
+            slotSize = std::max(sizeof(U), sizeof(FreeSlot));
+            slotSize = (slotSize + slotAlign - 1) / slotAlign * slotAlign;
+        }
+        return fits<U>();
+    }
+
+    /**
+     * @brief Fournit un emplacement, un type doit avoir été adopté
+     *
+     * @exception std::bad_alloc si un nouveau bloc ne peut être alloué
+     *
+     * @remark Complexité O(1) amorti
+     */
+    void *allocate()
+    {
+        if (freeList)
+        {
+            FreeSlot *s = freeList;
+            freeList = s->next;
+            return s;
+        }
+        if (cur == end)
+        {
+            grow(nextBlock);
+            nextBlock *= 2;
+        }
+        void *p = cur;
+        cur += slotSize;
+        return p;
+    }
+
+    /**
+     * @brief Rend un emplacement, qui sera réutilisé par allocate
+     *
+     * @remark Complexité O(1)
+     */
+    void deallocate(void *p) noexcept
+    {
+        FreeSlot *s = static_cast<FreeSlot *>(p);
+        s->next = freeList;
+        freeList = s;
+    }
+
+    /**
+     * @brief Garantit que les n prochaines allocations proviennent d'un
+     *        seul bloc contigu, un type doit avoir été adopté
+     *
+     * @remark Complexité O(1)
+     */
+    void reserve(size_t n)
+    {
+        if (size_t(end - cur) < n * slotSize)
+        {
+            grow(n);
+        }
+    }
+
+    /**
+     * @brief Rend toute la mémoire de l'arène, sans détruire les objets
+     *
+     * @remark Complexité O(B) avec B le nombre de blocs
+     */
+    void release() noexcept
+    {
+        for (char *b : blocks)
+        {
+            ::operator delete(b);
+        }
+        blocks.clear();
+        cur = end = nullptr;
+        freeList = nullptr;
+    }
+
+private:
+    void grow(size_t n)
+    {
+        blocks.reserve(blocks.size() + 1);
+        char *b = static_cast<char *>(::operator new(n * slotSize));
+        blocks.push_back(b);
+        cur = b;
+        end = b + n * slotSize;
+    }
+};
+
+/**
+ *  @brief Allocateur au modèle de la bibliothèque standard utilisant une
+ *         NodeArena partagée entre ses copies.
+ *
+ *  L'arène est aussi partagée par les conversions vers un autre type
+ *  (rebind) : un conteneur qui convertit son allocateur de noeuds en
+ *  ArenaAllocator<T> et retour obtient la même arène, et donc un
+ *  allocateur égal. Les allocations unitaires d'un type qui tient dans
+ *  les emplacements de l'arène passent par elle, les autres par
+ *  l'opérateur new global.
+ *
+ *  Une copie de conteneur reçoit une arène neuve
+ *  (select_on_container_copy_construction), un conteneur peut donc libérer
+ *  tous ses noeuds en O(1) par release() lorsqu'il est seul à utiliser son
+ *  arène.
+ */
+template <typename U>
+class ArenaAllocator
+{
+    template <typename V>
+    friend class ArenaAllocator;
+
+    std::shared_ptr<NodeArena> arena; // créée à la première allocation
+
+public:
+    using value_type = U;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept
+    {
+    }
+
+    template <typename V>
+    ArenaAllocator(const ArenaAllocator<V> &other) noexcept : arena(other.arena)
+    {
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const
+    {
+        return ArenaAllocator();
+    }
+
+    U *allocate(size_t n)
+    {
+        if (n == 1)
+        {
+            NodeArena &a = instance();
+            if (a.template adopt<U>())
+            {
+                return static_cast<U *>(a.allocate());
+            }
+        }
+        return static_cast<U *>(::operator new(n * sizeof(U)));
+    }
+
+    /**
+     * @remark p doit provenir de cet allocateur ou d'un allocateur égal :
+     *         un objet seul a toujours été alloué avec une arène
+     */
+    void deallocate(U *p, size_t n) noexcept
+    {
+        if (n == 1)
+        {
+            assert(arena && "objet non alloue par cet allocateur");
+            if (arena->template fits<U>())
+            {
+                arena->deallocate(p);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+    /**
+     * @brief Prépare un bloc contigu pour les n prochaines allocations
+     */
+    void reserve(size_t n)
+    {
+        NodeArena &a = instance();
+        if (a.template adopt<U>())
+        {
+            a.reserve(n);
+        }
+    }
+
+    /**
+     * @brief Rend toute la mémoire de l'arène si cet allocateur en est le
+     *        seul utilisateur
+     *
+     * @return true si la mémoire a été rendue, false si l'arène est
+     *         partagée ou s'il n'y en a pas : les objets doivent alors être
+     *         rendus un à un
+     *
+     * @remark Complexité O(B) avec B le nombre de blocs
+     */
+    bool release() noexcept
+    {
+        if (!arena || arena.use_count() != 1)
+        {
+            return false;
+        }
+        arena.reset();
+        return true;
+    }
+
+    template <typename V>
+    bool operator==(const ArenaAllocator<V> &other) const noexcept
+    {
+        return arena == other.arena;
+    }
+
+    template <typename V>
+    bool operator!=(const ArenaAllocator<V> &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    NodeArena &instance()
+    {
+        if (!arena)
+        {
+            arena = std::make_shared<NodeArena>();
+        }
+        return *arena;
+    }
+};
+
+#endif
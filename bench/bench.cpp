@@ -0,0 +1,275 @@
+//  Temps des opérations de l'arbre, comparé à std::set et à un vecteur trié
+//
+//  Pour chaque structure, chaque ordre de clefs et chaque taille N de 10^min
+//  à 10^max, mesure le temps par opération de insert, contains,
+//  deleteElement, rank, nth_element, visitSym, de la copie et de balance().
+//  Les ordres sont : aléatoire, croissant, décroissant et Zipf (clefs tirées
+//  avec une probabilité en 1/rang, donc avec doublons, recherches aussi
+//  tirées selon Zipf). Chaque configuration s'exécute dans un processus
+//  fils, dont le pic de mémoire résidente (getrusage) est rapporté.
+//
+//  NoBalance n'est pas mesuré : une insertion croissante le dégénère en
+//  liste, et sa récursion déborderait la pile dès 10^5 clefs.
+//
+//  usage : bench [--csv] [--min puissance] [--max puissance]
+//          par défaut de 10^3 à 10^6 ; --max 8 pour 10^8 clefs (plusieurs Go)
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+static volatile size_t sink; // empêche l'élimination des lectures
+
+struct Workload {
+  const char* name;
+  vector<int> keys;    // ordre d'insertion et de suppression
+  vector<int> queries; // clefs cherchées
+};
+
+// N tirages de rang selon Zipf d'exposant 1 (densité en 1/x), chaque rang
+// étant associé à une clef par une bijection de [0, N[ qui disperse les
+// clefs fréquentes dans l'arbre
+static vector<int> zipf(size_t n, mt19937_64& g) {
+  uniform_real_distribution<double> u(0, 1);
+  double ln = log(double(n) + 1);
+  const unsigned long long P = 1000000007ULL; // premier, donc premier avec N
+  vector<int> v(n);
+  for (int& k : v) {
+    unsigned long long r = (unsigned long long)(exp(u(g) * ln)) - 1;
+    k = int(min<unsigned long long>(r, n - 1) * P % n);
+  }
+  return v;
+}
+
+static Workload makeWorkload(const string& name, size_t n) {
+  mt19937_64 g(42);
+  Workload w;
+  w.name = name == "random" ? "random" : name == "sorted" ? "sorted"
+         : name == "reverse" ? "reverse" : "zipf";
+  if (name == "zipf") {
+    w.keys = zipf(n, g);
+    w.queries = zipf(n, g);
+    return w;
+  }
+  w.keys.resize(n);
+  iota(w.keys.begin(), w.keys.end(), 0);
+  if (name == "reverse") reverse(w.keys.begin(), w.keys.end());
+  w.queries = w.keys;
+  if (name == "random") {
+    shuffle(w.keys.begin(), w.keys.end(), g);
+    shuffle(w.queries.begin(), w.queries.end(), g);
+  }
+  return w;
+}
+
+// BinarySearchTree avec la politique Balance
+template <typename Balance>
+struct TreeAdapter {
+  typedef BinarySearchTree<int, Balance> Tree;
+  Tree t;
+  static const bool ordered = true;   // rank, nth_element
+  static const bool erasable = true;  // deleteElement
+  static const bool balanceable = true;
+  void insertAll(const vector<int>& keys) { for (int k : keys) t.insert(k); }
+  bool contains(int k) const { return t.contains(k); }
+  size_t rank(int k) const { return t.rank(k); }
+  int nth(size_t i) const { return t.nth_element(i); }
+  size_t size() const { return t.size(); }
+  size_t visit() { size_t s = 0; t.visitSym([&s](int k) { s += size_t(k); }); return s; }
+  size_t copy() const { Tree c(t); return c.size(); }
+  void balance() { t.balance(); }
+  void eraseAll(const vector<int>& keys) { for (int k : keys) t.deleteElement(k); }
+};
+
+struct SetAdapter {
+  set<int> t;
+  static const bool ordered = false; // rang en O(N) seulement
+  static const bool erasable = true;
+  static const bool balanceable = false;
+  void insertAll(const vector<int>& keys) { for (int k : keys) t.insert(k); }
+  bool contains(int k) const { return t.count(k) != 0; }
+  size_t rank(int) const { return 0; }
+  int nth(size_t) const { return 0; }
+  size_t size() const { return t.size(); }
+  size_t visit() { size_t s = 0; for (int k : t) s += size_t(k); return s; }
+  size_t copy() const { set<int> c(t); return c.size(); }
+  void balance() {}
+  void eraseAll(const vector<int>& keys) { for (int k : keys) t.erase(k); }
+};
+
+// vecteur trié construit d'un bloc : la référence des recherches, mais une
+// suppression y coûte O(N)
+struct VectorAdapter {
+  vector<int> t;
+  static const bool ordered = true;
+  static const bool erasable = false;
+  static const bool balanceable = false;
+  void insertAll(const vector<int>& keys) {
+    t.assign(keys.begin(), keys.end());
+    sort(t.begin(), t.end());
+    t.erase(unique(t.begin(), t.end()), t.end());
+  }
+  bool contains(int k) const { return binary_search(t.begin(), t.end(), k); }
+  size_t rank(int k) const {
+    vector<int>::const_iterator it = lower_bound(t.begin(), t.end(), k);
+    return it != t.end() && *it == k ? size_t(it - t.begin()) : size_t(-1);
+  }
+  int nth(size_t i) const { return t[i]; }
+  size_t size() const { return t.size(); }
+  size_t visit() { size_t s = 0; for (int k : t) s += size_t(k); return s; }
+  size_t copy() const { vector<int> c(t); return c.size(); }
+  void balance() {}
+  void eraseAll(const vector<int>&) {}
+};
+
+struct Measure {
+  const char* op;
+  double ns;  // temps total
+  double ops; // nombre total d'opérations
+};
+
+class Timer {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+public:
+  double ns() const {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+  }
+};
+
+static void add(vector<Measure>& m, const char* op, double ns, double ops) {
+  for (Measure& x : m)
+    if (strcmp(x.op, op) == 0) { x.ns += ns; x.ops += ops; return; }
+  m.push_back(Measure{op, ns, ops});
+}
+
+// mesure toutes les opérations de la structure, répétées sur des
+// structures neuves jusqu'à 10^5 opérations de chaque sorte
+template <typename Adapter>
+static vector<Measure> measure(const Workload& w) {
+  vector<Measure> m;
+  size_t n = w.keys.size();
+  size_t reps = max<size_t>(1, 100000 / n);
+  for (size_t r = 0; r < reps; ++r) {
+    Adapter a;
+    { Timer t; a.insertAll(w.keys); add(m, "insert", t.ns(), double(n)); }
+    {
+      Timer t; size_t s = 0;
+      for (int k : w.queries) s += a.contains(k);
+      add(m, "contains", t.ns(), double(n)); sink = s;
+    }
+    if (Adapter::ordered) {
+      Timer t; size_t s = 0;
+      for (int k : w.queries) s += a.rank(k);
+      add(m, "rank", t.ns(), double(n)); sink = s;
+    }
+    if (Adapter::ordered) {
+      size_t size = a.size();
+      Timer t; size_t s = 0;
+      for (int k : w.queries) s += size_t(a.nth(size_t(k) % size));
+      add(m, "nth_element", t.ns(), double(n)); sink = s;
+    }
+    { Timer t; sink = a.visit(); add(m, "visitSym", t.ns(), double(a.size())); }
+    { Timer t; sink = a.copy(); add(m, "copy", t.ns(), double(a.size())); }
+    if (Adapter::balanceable) {
+      Timer t; a.balance(); add(m, "balance", t.ns(), double(a.size()));
+    }
+    if (Adapter::erasable) {
+      Timer t; a.eraseAll(w.keys); add(m, "deleteElement", t.ns(), double(n));
+    }
+  }
+  return m;
+}
+
+static long peakRssKiB() {
+  struct rusage u;
+  getrusage(RUSAGE_SELF, &u);
+  return u.ru_maxrss; // en KiB sous Linux
+}
+
+static void print(bool csv, const char* structure, const Workload& w,
+                  const vector<Measure>& m) {
+  long rss = peakRssKiB();
+  for (const Measure& x : m) {
+    double ns = x.ns / x.ops;
+    if (csv)
+      printf("%s,%s,%zu,%s,%.2f,%.3f,%ld\n", structure, w.name, w.keys.size(),
+             x.op, ns, 1e3 / ns, rss);
+    else
+      printf("%-14s %-8s %10zu %-14s %10.1f %10.2f %12ld\n", structure, w.name,
+             w.keys.size(), x.op, ns, 1e3 / ns, rss);
+  }
+}
+
+// exécute une configuration dans un processus fils, pour que son pic de
+// mémoire ne soit pas celui des configurations précédentes
+template <typename Adapter>
+static bool run(bool csv, const char* structure, const char* workload, size_t n) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return false;
+  }
+  if (pid == 0) {
+    Workload w = makeWorkload(workload, n);
+    vector<Measure> m = measure<Adapter>(w);
+    print(csv, structure, w, m);
+    fflush(stdout);
+    _exit(0);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "%s %s %zu: échec\n", structure, workload, n);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  bool csv = false;
+  int minPow = 3, maxPow = 6;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--csv") == 0) csv = true;
+    else if (strcmp(argv[i], "--min") == 0 && i + 1 < argc) minPow = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) maxPow = atoi(argv[++i]);
+    else {
+      fprintf(stderr, "usage : %s [--csv] [--min puissance] [--max puissance]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (csv)
+    printf("structure,workload,n,operation,ns_per_op,mops,peak_rss_kib\n");
+  else
+    printf("%-14s %-8s %10s %-14s %10s %10s %12s\n", "structure", "workload", "n",
+           "operation", "ns/op", "Mop/s", "peak RSS KiB");
+
+  const char* workloads[] = {"random", "sorted", "reverse", "zipf"};
+  bool ok = true;
+  size_t n = 1;
+  for (int p = 0; p < minPow; ++p) n *= 10;
+  for (int p = minPow; p <= maxPow; ++p, n *= 10) {
+    for (const char* w : workloads) {
+      ok = run<TreeAdapter<RedBlackBalance> >(csv, "bst-rb", w, n) && ok;
+      ok = run<TreeAdapter<AvlBalance> >(csv, "bst-avl", w, n) && ok;
+      ok = run<TreeAdapter<ScapegoatBalance<> > >(csv, "bst-scapegoat", w, n) && ok;
+      ok = run<SetAdapter>(csv, "std::set", w, n) && ok;
+      ok = run<VectorAdapter>(csv, "vector", w, n) && ok;
+    }
+  }
+  return ok ? 0 : 1;
+}
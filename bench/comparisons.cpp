@@ -0,0 +1,73 @@
+//  Nombre de comparaisons de clefs par opération
+//
+//  Compte les appels aux opérateurs de comparaison de la clef pendant
+//  insert, contains, rank et deleteElement, pour des insertions en ordre
+//  aléatoire et en ordre croissant.
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+static size_t comparisons = 0;
+
+// clef entière comptant chacune de ses comparaisons
+class Key {
+  int val;
+public:
+  Key(int i = 0) : val(i) {
+  }
+  bool operator == (const Key& k) const noexcept { ++comparisons; return val == k.val; }
+  bool operator != (const Key& k) const noexcept { ++comparisons; return val != k.val; }
+  bool operator <  (const Key& k) const noexcept { ++comparisons; return val <  k.val; }
+  bool operator >  (const Key& k) const noexcept { ++comparisons; return val >  k.val; }
+  bool operator <= (const Key& k) const noexcept { ++comparisons; return val <= k.val; }
+  bool operator >= (const Key& k) const noexcept { ++comparisons; return val >= k.val; }
+  friend ostream& operator<< (ostream& os, const Key& k) { return os << k.val; }
+};
+
+// exécute op sur chaque clef et affiche le nombre moyen de comparaisons
+template <typename Op>
+static void measure(const char* policy, const char* order, const char* name,
+                    const vector<int>& keys, Op op) {
+  comparisons = 0;
+  for (int k : keys)
+    op(Key(k));
+  printf("%-10s %-8s %-14s %10.2f\n", policy, order, name,
+         double(comparisons) / double(keys.size()));
+}
+
+template <typename Balance>
+static void run(const char* policy, const char* order, const vector<int>& keys) {
+  BinarySearchTree<Key, Balance> tree;
+  vector<int> absent(keys.size());
+  transform(keys.begin(), keys.end(), absent.begin(), [](int k) { return -k - 1; });
+
+  measure(policy, order, "insert", keys, [&](const Key& k) { tree.insert(k); });
+  measure(policy, order, "insert (dup)", keys, [&](const Key& k) { tree.insert(k); });
+  measure(policy, order, "contains", keys, [&](const Key& k) { tree.contains(k); });
+  measure(policy, order, "contains (abs)", absent, [&](const Key& k) { tree.contains(k); });
+  measure(policy, order, "rank", keys, [&](const Key& k) { tree.rank(k); });
+  measure(policy, order, "rank (abs)", absent, [&](const Key& k) { tree.rank(k); });
+  measure(policy, order, "delete (abs)", absent, [&](const Key& k) { tree.deleteElement(k); });
+  measure(policy, order, "delete", keys, [&](const Key& k) { tree.deleteElement(k); });
+}
+
+int main(int argc, char* argv[]) {
+  size_t n = argc > 1 ? size_t(atol(argv[1])) : 1 << 14;
+
+  vector<int> sorted(n);
+  iota(sorted.begin(), sorted.end(), 0);
+  vector<int> shuffled = sorted;
+  shuffle(shuffled.begin(), shuffled.end(), mt19937(42));
+
+  printf("%-10s %-8s %-14s %10s\n", "policy", "order", "operation", "cmp/op");
+  run<NoBalance>("none", "random", shuffled);
+  run<AvlBalance>("avl", "random", shuffled);
+  run<AvlBalance>("avl", "sorted", sorted);
+  run<RedBlackBalance>("red-black", "random", shuffled);
+  run<RedBlackBalance>("red-black", "sorted", sorted);
+  return 0;
+}
@@ -0,0 +1,105 @@
+//  Débit de l'arbre partagé entre threads
+//
+//  Compare ConcurrentSearchTree à un BinarySearchTree protégé par un verrou
+//  global, pour un mélange de lectures (contains, rank) et d'écritures
+//  (insert, deleteElement) sur des clefs aléatoires. Vérifie ensuite que
+//  des insertions et suppressions simultanées de clefs disjointes laissent
+//  l'arbre dans l'état attendu.
+//
+//  usage : concurrent [threads max] [% d'écritures] [opérations par thread]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "binary_search_tree.cpp"
+#include "concurrent_search_tree.cpp"
+
+static const int KEYS = 1 << 20;
+
+// arbre séquentiel derrière un verrou global
+class LockedTree {
+  BinarySearchTree<int, RedBlackBalance> tree;
+  mutable std::mutex mutex;
+public:
+  void insert(int k) { std::lock_guard<std::mutex> lock(mutex); tree.insert(k); }
+  bool deleteElement(int k) { std::lock_guard<std::mutex> lock(mutex); return tree.deleteElement(k); }
+  bool contains(int k) const { std::lock_guard<std::mutex> lock(mutex); return tree.contains(k); }
+  size_t rank(int k) const { std::lock_guard<std::mutex> lock(mutex); return tree.rank(k); }
+};
+
+// millions d'opérations par seconde avec threads threads
+template <typename Tree>
+static double throughput(Tree& tree, unsigned threads, unsigned writes, size_t ops) {
+  std::atomic<size_t> sink(0);
+  std::vector<std::thread> pool;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back([&tree, &sink, t, writes, ops] {
+      std::mt19937 g(t + 1);
+      size_t local = 0;
+      for (size_t i = 0; i < ops; ++i) {
+        int k = int(g() % KEYS);
+        unsigned op = unsigned(g() % 100);
+        if (op < writes / 2) tree.insert(k);
+        else if (op < writes) local += tree.deleteElement(k);
+        else if (op % 2) local += tree.contains(k);
+        else local += tree.rank(k);
+      }
+      sink += local;
+    });
+  }
+  for (std::thread& th : pool) th.join();
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return double(threads * ops) / s / 1e6;
+}
+
+// chaque thread insère puis supprime la moitié de ses propres clefs
+static bool stress(unsigned threads, int perThread) {
+  ConcurrentSearchTree<int> tree;
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back([&tree, t, threads, perThread] {
+      for (int i = 0; i < perThread; ++i) tree.insert(i * int(threads) + int(t));
+      for (int i = 0; i < perThread; i += 2) tree.deleteElement(i * int(threads) + int(t));
+    });
+  }
+  for (std::thread& th : pool) th.join();
+  size_t expected = size_t(threads) * size_t(perThread / 2);
+  if (tree.size() != expected) return false;
+  for (size_t i = 0; i < tree.size(); ++i) {
+    // restent les clefs i * threads + t de i impair
+    int k = tree.nth_element(i);
+    if (tree.rank(k) != i || (k / int(threads)) % 2 == 0) return false;
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned maxThreads = argc > 1 ? unsigned(atoi(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+  unsigned writes = argc > 2 ? unsigned(atoi(argv[2])) : 10;
+  size_t ops = argc > 3 ? size_t(atol(argv[3])) : 200000;
+
+  ConcurrentSearchTree<int> concurrent;
+  LockedTree locked;
+  std::mt19937 g(42);
+  for (int i = 0; i < KEYS / 2; ++i) {
+    int k = int(g() % KEYS);
+    concurrent.insert(k);
+    locked.insert(k);
+  }
+
+  printf("%-8s %8s %14s %14s\n", "threads", "writes", "locked Mop/s", "concur Mop/s");
+  for (unsigned t = 1; t <= maxThreads; t *= 2) {
+    double l = throughput(locked, t, writes, ops);
+    double c = throughput(concurrent, t, writes, ops);
+    printf("%-8u %7u%% %14.2f %14.2f\n", t, writes, l, c);
+  }
+
+  bool ok = stress(std::max(2u, maxThreads), 20000);
+  printf("stress: %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
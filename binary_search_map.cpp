@@ -0,0 +1,350 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : binary_search_map.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Tableau associatif trié construit sur BinarySearchTree, avec
+               agrégats des valeurs par intervalle de clefs.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Chaque noeud de l'arbre contient une clef et sa valeur. Un
+               monoïde sur les valeurs est maintenu par sous-arbre comme
+               nbElements, une somme, un minimum ou un maximum sur un
+               intervalle de clefs se calcule donc en O(log(N)).
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef BINARY_SEARCH_MAP_CPP
+#define BINARY_SEARCH_MAP_CPP
+
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "binary_search_tree.cpp"
+
+/**
+ *  @brief Tableau associatif trié d'ordre statistique.
+ *
+ *  @tparam K: type des clefs
+ *  @tparam V: type des valeurs
+ *  @tparam Monoid: monoïde sur les valeurs (SumMonoid, MinMonoid, MaxMonoid
+ *                  ou autre, voir SumMonoid), maintenu par sous-arbre pour
+ *                  aggregate. void si aucun agrégat n'est nécessaire.
+ *  @tparam Balance: politique d'équilibrage de l'arbre
+ *  @tparam Compare: ordre strict des clefs
+ *
+ *  Les valeurs ne se modifient que par le tableau, qui met à jour les
+ *  agrégats des ancêtres du noeud modifié.
+ */
+template <typename K, typename V, typename Monoid = void,
+          typename Balance = RedBlackBalance, typename Compare = std::less<K>>
+class BinarySearchMap
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+    /**
+     *  @brief Elément du tableau : une clef et sa valeur
+     */
+    class Entry
+    {
+        friend class BinarySearchMap;
+
+        K _key;
+        mutable V _value; // ne participe pas à l'ordre
+
+    public:
+        // valeur construite sur place à partir de args
+        template <typename... Args>
+        Entry(const K &key, Args &&... args) : _key(key), _value(std::forward<Args>(args)...)
+        {
+        }
+
+        const K &key() const noexcept
+        {
+            return _key;
+        }
+
+        const V &value() const noexcept
+        {
+            return _value;
+        }
+    };
+
+    using value_type = Entry;
+
+private:
+    static const K &keyOf(const Entry &e) noexcept
+    {
+        return e.key();
+    }
+
+    static const K &keyOf(const K &key) noexcept
+    {
+        return key;
+    }
+
+    // vrai si Compare ne peut lever d'exception
+    static constexpr bool nothrowCompare =
+            noexcept(Compare()(std::declval<const K &>(), std::declval<const K &>()));
+
+    // ordre des éléments selon leur clef, transparent pour chercher une clef
+    // sans construire d'élément
+    struct EntryCompare
+    {
+        using is_transparent = void;
+
+        template <typename A, typename B>
+        bool operator()(const A &a, const B &b) const noexcept(nothrowCompare)
+        {
+            return Compare()(keyOf(a), keyOf(b));
+        }
+
+        // une seule comparaison par niveau si Compare le permet sur K
+        template <typename A, typename B>
+        auto compare(const A &a, const B &b) const
+                -> decltype(ThreeWay<Compare>::compare(keyOf(a), keyOf(b), 0))
+        {
+            return ThreeWay<Compare>::compare(keyOf(a), keyOf(b), 0);
+        }
+    };
+
+    // argument de Monoid::of
+    struct ValueOf
+    {
+        const V &operator()(const Entry &e) const noexcept
+        {
+            return e.value();
+        }
+    };
+
+    using Augment = typename std::conditional<std::is_void<Monoid>::value, NoAugment,
+                                              MonoidAugment<Monoid, ValueOf>>::type;
+
+public:
+    using Tree = BinarySearchTree<Entry, Balance, std::allocator<Entry>, NoTrace,
+                                  EntryCompare, Augment>;
+    using const_iterator = typename Tree::const_iterator;
+    using node_type = typename Tree::node_type;
+
+private:
+    Tree tree;
+
+public:
+    /**
+     * @brief Insertion d'une clef et de sa valeur, si la clef est absente
+     *
+     * @return true si l'élément a été inséré
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    bool insert(const K &key, const V &value)
+    {
+        return try_emplace(key, value);
+    }
+
+    /**
+     * @brief Insertion d'une clef et d'une valeur construite sur place à
+     *        partir de args. Si la clef est présente, rien n'est alloué ni
+     *        construit.
+     *
+     * @return true si l'élément a été inséré
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    template <typename... Args>
+    bool try_emplace(const K &key, Args &&... args)
+    {
+        typename Tree::OperationScope scope(tree, Tree::Operation::Insert);
+        return tree.emplaceKey(key, key, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Insertion d'une clef et de sa valeur, ou remplacement de la
+     *        valeur si la clef est présente
+     *
+     * @return true si l'élément a été inséré, false s'il a été remplacé
+     *
+     * @remark Complexité O(log(N))
+     */
+    template <typename M>
+    bool insert_or_assign(const K &key, M &&value)
+    {
+        if(update(key, [&value](V &v) { v = std::forward<M>(value); })){
+            return false;
+        }
+        return try_emplace(key, std::forward<M>(value));
+    }
+
+    /**
+     * @brief Retire l'élément de la clef, sans le détruire
+     *
+     * @return Une poignée sur l'élément, vide si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    node_type extract(const K &key)
+    {
+        return tree.extract(key);
+    }
+
+    /**
+     * @brief Insertion de l'élément d'une poignée, sans allocation ni copie
+     *
+     * @return false si la poignée est vide ou la clef déjà présente, la
+     *         poignée gardant alors l'élément
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    bool insert(node_type &&handle)
+    {
+        return tree.insert(std::move(handle));
+    }
+
+    /**
+     * @brief Modifie en place la valeur d'une clef, puis met à jour les
+     *        agrégats
+     *
+     * @param fn: Appelée par fn(V &) sur la valeur de la clef
+     *
+     * @return false si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    template <typename Fn>
+    bool update(const K &key, Fn fn)
+    {
+        typename Tree::OperationScope scope(tree, Tree::Operation::Lookup);
+        auto modify = [&fn](const Entry &e) { fn(e._value); };
+        return Tree::modify(tree._root, key, modify);
+    }
+
+    /**
+     * @brief Supprime l'élément de la clef
+     *
+     * @return true si la clef était présente
+     *
+     * @remark Complexité O(log(N))
+     */
+    bool erase(const K &key) noexcept(nothrowCompare)
+    {
+        return tree.deleteElement(key);
+    }
+
+    bool contains(const K &key) const noexcept(nothrowCompare)
+    {
+        return tree.contains(key);
+    }
+
+    /**
+     * @brief Valeur d'une clef
+     *
+     * @exception std::out_of_range si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    const V &at(const K &key) const
+    {
+        const_iterator it = tree.find(key);
+        if(it == tree.end()){
+            throw std::out_of_range("La clef est absente du tableau");
+        }
+        return it->value();
+    }
+
+    const_iterator find(const K &key) const
+    {
+        return tree.find(key);
+    }
+
+    const_iterator lower_bound(const K &key) const
+    {
+        return tree.lower_bound(key);
+    }
+
+    const_iterator upper_bound(const K &key) const
+    {
+        return tree.upper_bound(key);
+    }
+
+    /**
+     * @brief Position d'une clef dans l'ordre croissant
+     *
+     * @return La position entre 0 et size()-1, size_t(-1) si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    size_t rank(const K &key) const noexcept(nothrowCompare)
+    {
+        return tree.rank(key);
+    }
+
+    /**
+     * @brief Elément de la clef en position n dans l'ordre croissant
+     *
+     * @exception std::out_of_range si n >= size()
+     *
+     * @remark Complexité O(log(N))
+     */
+    const Entry &nth_element(size_t n) const
+    {
+        return tree.nth_element(n);
+    }
+
+    size_t size() const noexcept
+    {
+        return tree.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return tree.size() == 0;
+    }
+
+    void clear() noexcept
+    {
+        tree.clear();
+    }
+
+    const_iterator begin() const
+    {
+        return tree.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return tree.end();
+    }
+
+    /**
+     * @brief Combinaison par Monoid de toutes les valeurs, par ordre
+     *        croissant des clefs
+     *
+     * @remark Complexité O(1)
+     */
+    template <typename M = Monoid>
+    typename M::value_type aggregate() const
+    {
+        return tree.aggregate();
+    }
+
+    /**
+     * @brief Combinaison par Monoid des valeurs des clefs de [lo, hi[, par
+     *        ordre croissant des clefs
+     *
+     * @return Monoid::identity() si aucune clef n'est dans l'intervalle
+     *
+     * @remark Complexité O(log(N))
+     */
+    template <typename M = Monoid>
+    typename M::value_type aggregate(const K &lo, const K &hi) const
+    {
+        return tree.aggregate(lo, hi);
+    }
+};
+
+#endif
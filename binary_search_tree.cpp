@@ -13,6 +13,9 @@
  -----------------------------------------------------------------------------------
 */
 
+#ifndef BINARY_SEARCH_TREE_CPP
+#define BINARY_SEARCH_TREE_CPP
+
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
@@ -21,582 +24,4030 @@
 #include <queue>
 #include <cassert>
 #include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <atomic>
+#include <iterator>
+#include <vector>
+#include <climits>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "arena_allocator.cpp"
+#include "frozen_search_tree.cpp"
+#include "thread_pool.cpp"
 
 using namespace std;
 
-template <typename T>
-class BinarySearchTree
+/**
+ *  @brief Politique d'équilibrage par défaut : aucun rééquilibrage.
+ *
+ *  Une politique d'équilibrage fournit un type NodeData (hérité par chaque
+ *  noeud) et des fonctions appelées par l'arbre sur le chemin de remontée
+ *  d'une insertion ou d'une suppression. Les rotations fournies par l'arbre
+ *  maintiennent nbElements, la politique ne gère que ses propres données.
+ */
+struct NoBalance
 {
-public:
-    using value_type = T;
-    using reference = T &;
-    using const_reference = const T &;
+    struct NodeData
+    {
+    };
+
+    // appelée sur chaque ancêtre dont un sous-arbre a reçu une nouvelle clef
+    template <typename Tree, typename Node>
+    static void onInsert(Node *&) noexcept
+    {
+    }
+
+    // appelée sur l'ancêtre r dont le sous-arbre gauche (leftSide) ou droit
+    // a perdu un noeud. Retourne true si le parent doit aussi être corrigé
+    template <typename Tree, typename Node>
+    static bool onErase(Node *&, bool) noexcept
+    {
+        return false;
+    }
+
+    // appelée quand removed (au plus un enfant) est remplacé par replacement.
+    // Retourne true si les ancêtres doivent être corrigés
+    template <typename Tree, typename Node>
+    static bool onUnlink(Node *, Node *&) noexcept
+    {
+        return false;
+    }
+
+    // appelée sur la racine de l'arbre après chaque modification
+    template <typename Tree, typename Node>
+    static void fixRoot(Node *) noexcept
+    {
+    }
+
+    // appelée sur la racine d'un arbre reconstruit par arborize
+    template <typename Tree, typename Node>
+    static void onRebuild(Node *) noexcept
+    {
+    }
+
+    // rang d'un sous-arbre, transmis à join : une mesure de sa hauteur que
+    // la politique ne mémorise pas dans les noeuds. O(log(N)) au plus
+    template <typename Tree, typename Node>
+    static int rank(const Node *) noexcept
+    {
+        return 0;
+    }
+
+    // rang de l'enfant child de parent, connaissant le rang de parent. O(1)
+    template <typename Tree, typename Node>
+    static int childRank(const Node *, int, const Node *) noexcept
+    {
+        return 0;
+    }
+
+    // vrai si les données de la politique au noeud r respectent ses
+    // invariants, ceux de ses sous-arbres ayant déjà été vérifiés
+    template <typename Tree, typename Node>
+    static bool valid(const Node *) noexcept
+    {
+        return true;
+    }
+
+    // réunit les sous-arbres l et r autour du noeud m, toutes les clefs de l
+    // étant inférieures à celle de m et celles de r supérieures, et retourne
+    // la racine du résultat dont le rang est écrit dans rank. Les données de
+    // m sont à réinitialiser. Ici m est simplement posé au-dessus de l et r
+    template <typename Tree, typename Node>
+    static Node *join(Node *l, int, Node *m, Node *r, int, int &rank) noexcept
+    {
+        rank = 0;
+        return Tree::attach(l, m, r);
+    }
+};
+
+/**
+ *  @brief Politique d'équilibrage AVL.
+ *
+ *  Chaque noeud mémorise la hauteur de son sous-arbre. Les facteurs
+ *  d'équilibre sont corrigés par rotations sur le chemin de remontée, ce qui
+ *  garantit une hauteur inférieure à 1.44 log2(N).
+ */
+struct AvlBalance
+{
+    struct NodeData
+    {
+        int height = 1; // hauteur du sous-arbre dont ce noeud est la racine
+    };
+
+    template <typename Tree, typename Node>
+    static void onInsert(Node *&r) noexcept
+    {
+        rebalance<Tree>(r);
+    }
+
+    template <typename Tree, typename Node>
+    static bool onErase(Node *&r, bool) noexcept
+    {
+        rebalance<Tree>(r);
+        return true;
+    }
+
+    template <typename Tree, typename Node>
+    static bool onUnlink(Node *, Node *&) noexcept
+    {
+        return true;
+    }
+
+    template <typename Tree, typename Node>
+    static void fixRoot(Node *) noexcept
+    {
+    }
+
+    template <typename Tree, typename Node>
+    static void onRebuild(Node *r) noexcept
+    {
+        if (r)
+        {
+            onRebuild<Tree>(r->left);
+            onRebuild<Tree>(r->right);
+            update(r);
+        }
+    }
+
+    // la hauteur est mémorisée dans les noeuds, le rang n'est pas utilisé
+    template <typename Tree, typename Node>
+    static int rank(const Node *) noexcept
+    {
+        return 0;
+    }
+
+    template <typename Tree, typename Node>
+    static int childRank(const Node *, int, const Node *) noexcept
+    {
+        return 0;
+    }
+
+    // hauteur exacte et facteur d'équilibre compris entre -1 et 1
+    template <typename Tree, typename Node>
+    static bool valid(const Node *r) noexcept
+    {
+        int bf = height(r->left) - height(r->right);
+        return r->height == 1 + std::max(height(r->left), height(r->right)) &&
+               bf >= -1 && bf <= 1;
+    }
+
+    /**
+     * @brief Descend le long du bord intérieur du plus haut des deux arbres
+     *        jusqu'à un sous-arbre de hauteur proche de l'autre, y place m,
+     *        puis rééquilibre en remontant.
+     *
+     * @remark Complexité O(|h(l) - h(r)| + 1)
+     */
+    template <typename Tree, typename Node>
+    static Node *join(Node *l, int, Node *m, Node *r, int, int &rank) noexcept
+    {
+        rank = 0;
+        if (height(l) > height(r) + 1)
+        {
+            l->right = join<Tree>(l->right, 0, m, r, 0, rank);
+            l->nbElements = Tree::size(l->left) + Tree::size(l->right) + 1;
+            Tree::augment(l);
+            rebalance<Tree>(l);
+            return l;
+        }
+        if (height(r) > height(l) + 1)
+        {
+            r->left = join<Tree>(l, 0, m, r->left, 0, rank);
+            r->nbElements = Tree::size(r->left) + Tree::size(r->right) + 1;
+            Tree::augment(r);
+            rebalance<Tree>(r);
+            return r;
+        }
+        Tree::attach(l, m, r);
+        update(m);
+        return m;
+    }
 
 private:
+    template <typename Node>
+    static int height(const Node *r) noexcept
+    {
+        return r ? r->height : 0;
+    }
+
+    template <typename Node>
+    static void update(Node *r) noexcept
+    {
+        r->height = 1 + std::max(height(r->left), height(r->right));
+    }
+
     /**
-     *  @brief Noeud de l'arbre.
+     * @brief Rétablit le facteur d'équilibre de r par une rotation simple
+     *        ou double
+     *
+     * @remark Complexité O(1)
+     */
+    template <typename Tree, typename Node>
+    static void rebalance(Node *&r) noexcept
+    {
+        update(r);
+        int bf = height(r->left) - height(r->right);
+        if (bf > 1)
+        {
+            if (height(r->left->left) < height(r->left->right))
+            {
+                Tree::rotateLeft(r->left);
+                update(r->left->left);
+                update(r->left);
+            }
+            Tree::rotateRight(r);
+            update(r->right);
+            update(r);
+        }
+        else if (bf < -1)
+        {
+            if (height(r->right->right) < height(r->right->left))
+            {
+                Tree::rotateRight(r->right);
+                update(r->right->right);
+                update(r->right);
+            }
+            Tree::rotateLeft(r);
+            update(r->left);
+            update(r);
+        }
+    }
+};
+
+/**
+ *  @brief Politique d'équilibrage rouge-noir.
+ *
+ *  Les corrections sont faites de bas en haut pendant la remontée de la
+ *  récursion : une violation rouge-rouge est traitée par le grand-parent,
+ *  un déficit de noirs après suppression par le parent du sous-arbre
+ *  déficitaire. La hauteur reste inférieure à 2 log2(N + 1).
+ */
+struct RedBlackBalance
+{
+    struct NodeData
+    {
+        bool red = true; // un nouveau noeud est toujours rouge
+    };
+
+    template <typename Tree, typename Node>
+    static void onInsert(Node *&g) noexcept
+    {
+        bool leftViolation = isRed(g->left) &&
+                             (isRed(g->left->left) || isRed(g->left->right));
+        bool rightViolation = isRed(g->right) &&
+                              (isRed(g->right->left) || isRed(g->right->right));
+        if (!leftViolation && !rightViolation)
+        {
+            return;
+        }
+        // oncle rouge : simple changement de couleurs
+        if (isRed(g->left) && isRed(g->right))
+        {
+            g->red = true;
+            g->left->red = false;
+            g->right->red = false;
+        }
+        else if (leftViolation)
+        {
+            if (isRed(g->left->right))
+            {
+                Tree::rotateLeft(g->left);
+            }
+            Tree::rotateRight(g);
+            g->red = false;
+            g->right->red = true;
+        }
+        else
+        {
+            if (isRed(g->right->left))
+            {
+                Tree::rotateRight(g->right);
+            }
+            Tree::rotateLeft(g);
+            g->red = false;
+            g->left->red = true;
+        }
+    }
+
+    template <typename Tree, typename Node>
+    static bool onErase(Node *&p, bool leftSide) noexcept
+    {
+        return leftSide ? fixLeft<Tree>(p) : fixRight<Tree>(p);
+    }
+
+    template <typename Tree, typename Node>
+    static bool onUnlink(Node *removed, Node *&replacement) noexcept
+    {
+        if (removed->red)
+        {
+            return false;
+        }
+        if (isRed(replacement))
+        {
+            replacement->red = false;
+            return false;
+        }
+        return true;
+    }
+
+    template <typename Tree, typename Node>
+    static void fixRoot(Node *root) noexcept
+    {
+        if (root)
+        {
+            root->red = false;
+        }
+    }
+
+    /**
+     * @remark Un arbre issu d'arborize a toutes ses feuilles sur les deux
+     *         derniers niveaux : le dernier niveau est colorié en rouge,
+     *         tous les autres noeuds en noir.
+     */
+    template <typename Tree, typename Node>
+    static void onRebuild(Node *r) noexcept
+    {
+        size_t h = 0;
+        for (size_t n = r ? r->nbElements : 0; n; n >>= 1)
+        {
+            ++h;
+        }
+        color(r, 1, h);
+    }
+
+    // le rang est la hauteur noire : nombre de noeuds noirs de r, compris,
+    // jusqu'à une feuille vide
+    template <typename Tree, typename Node>
+    static int rank(const Node *r) noexcept
+    {
+        int bh = 0;
+        for (; r; r = r->left)
+        {
+            bh += !r->red;
+        }
+        return bh;
+    }
+
+    template <typename Tree, typename Node>
+    static int childRank(const Node *parent, int rank, const Node *) noexcept
+    {
+        return rank - !parent->red;
+    }
+
+    // pas de noeud rouge sous un noeud rouge, même hauteur noire à gauche et
+    // à droite. O(log(N))
+    template <typename Tree, typename Node>
+    static bool valid(const Node *r) noexcept
+    {
+        return !(r->red && (isRed(r->left) || isRed(r->right))) &&
+               rank<Tree>(r->left) == rank<Tree>(r->right);
+    }
+
+    /**
+     * @brief Les racines de l et r sont noircies, puis m est placé en rouge
+     *        le long du bord intérieur de l'arbre de plus grande hauteur
+     *        noire, au-dessus du noeud noir de même hauteur noire que
+     *        l'autre arbre. Les violations rouge-rouge sont corrigées en
+     *        remontant, comme après une insertion.
+     *
+     * @remark Complexité O(|bh(l) - bh(r)| + 1)
+     */
+    template <typename Tree, typename Node>
+    static Node *join(Node *l, int bl, Node *m, Node *r, int br, int &rank) noexcept
+    {
+        if (isRed(l))
+        {
+            l->red = false;
+            ++bl;
+        }
+        if (isRed(r))
+        {
+            r->red = false;
+            ++br;
+        }
+        Node *root;
+        if (bl > br)
+        {
+            root = joinRight<Tree>(l, bl, m, r, br);
+            rank = bl;
+        }
+        else if (br > bl)
+        {
+            root = joinLeft<Tree>(l, bl, m, r, br);
+            rank = br;
+        }
+        else
+        {
+            root = Tree::attach(l, m, r);
+            root->red = true;
+            rank = bl;
+        }
+        if (root->red)
+        {
+            root->red = false;
+            ++rank;
+        }
+        return root;
+    }
+
+private:
+    // place m sur le bord droit de t, de hauteur noire bt > br
+    template <typename Tree, typename Node>
+    static Node *joinRight(Node *t, int bt, Node *m, Node *r, int br) noexcept
+    {
+        if (bt == br && !isRed(t))
+        {
+            Tree::attach(t, m, r);
+            m->red = true;
+            return m;
+        }
+        t->right = joinRight<Tree>(t->right, bt - !t->red, m, r, br);
+        t->nbElements = Tree::size(t->left) + Tree::size(t->right) + 1;
+        Tree::augment(t);
+        onInsert<Tree>(t);
+        return t;
+    }
+
+    // place m sur le bord gauche de t, de hauteur noire bt > bl
+    template <typename Tree, typename Node>
+    static Node *joinLeft(Node *l, int bl, Node *m, Node *t, int bt) noexcept
+    {
+        if (bt == bl && !isRed(t))
+        {
+            Tree::attach(l, m, t);
+            m->red = true;
+            return m;
+        }
+        t->left = joinLeft<Tree>(l, bl, m, t->left, bt - !t->red);
+        t->nbElements = Tree::size(t->left) + Tree::size(t->right) + 1;
+        Tree::augment(t);
+        onInsert<Tree>(t);
+        return t;
+    }
+
+    template <typename Node>
+    static bool isRed(const Node *r) noexcept
+    {
+        return r && r->red;
+    }
+
+    template <typename Node>
+    static void color(Node *r, size_t depth, size_t h) noexcept
+    {
+        if (r)
+        {
+            r->red = depth == h && h > 1;
+            color(r->left, depth + 1, h);
+            color(r->right, depth + 1, h);
+        }
+    }
+
+    /**
+     * @brief Corrige un déficit d'un noeud noir dans le sous-arbre gauche de p
+     *
+     * @return true si le déficit remonte au parent de p
+     */
+    template <typename Tree, typename Node>
+    static bool fixLeft(Node *&p) noexcept
+    {
+        Node *s = p->right;
+        if (s == nullptr)
+        {
+            return true; // arbre linéarisé, plus de garantie d'équilibre
+        }
+        if (s->red)
+        {
+            Tree::rotateLeft(p);
+            p->red = false;
+            p->left->red = true;
+            fixLeft<Tree>(p->left);
+            return false;
+        }
+        if (!isRed(s->left) && !isRed(s->right))
+        {
+            s->red = true;
+            if (p->red)
+            {
+                p->red = false;
+                return false;
+            }
+            return true;
+        }
+        if (!isRed(s->right))
+        {
+            Tree::rotateRight(p->right);
+            p->right->red = false;
+            p->right->right->red = true;
+        }
+        bool red = p->red;
+        Tree::rotateLeft(p);
+        p->red = red;
+        p->left->red = false;
+        p->right->red = false;
+        return false;
+    }
+
+    /**
+     * @brief Corrige un déficit d'un noeud noir dans le sous-arbre droit de p
      *
-     * contient une clef et les liens vers les sous-arbres droit et gauche.
+     * @return true si le déficit remonte au parent de p
+     */
+    template <typename Tree, typename Node>
+    static bool fixRight(Node *&p) noexcept
+    {
+        Node *s = p->left;
+        if (s == nullptr)
+        {
+            return true;
+        }
+        if (s->red)
+        {
+            Tree::rotateRight(p);
+            p->red = false;
+            p->right->red = true;
+            fixRight<Tree>(p->right);
+            return false;
+        }
+        if (!isRed(s->left) && !isRed(s->right))
+        {
+            s->red = true;
+            if (p->red)
+            {
+                p->red = false;
+                return false;
+            }
+            return true;
+        }
+        if (!isRed(s->left))
+        {
+            Tree::rotateLeft(p->left);
+            p->left->red = false;
+            p->left->left->red = true;
+        }
+        bool red = p->red;
+        Tree::rotateRight(p);
+        p->red = red;
+        p->right->red = false;
+        p->left->red = false;
+        return false;
+    }
+};
+
+/**
+ *  @brief Politique d'équilibrage par reconstructions partielles (scapegoat).
+ *
+ *  Aucune donnée n'est ajoutée aux noeuds : les compteurs nbElements du
+ *  chemin suffisent pour détecter un sous-arbre dont un enfant contient plus
+ *  d'une fraction alpha = AlphaNum / AlphaDen de ses noeuds. Ce sous-arbre
+ *  est reconstruit sur place par linearize et arborize, en O(k) et sans
+ *  allocation. Les mises à jour coûtent O(log(N)) amorti.
+ *
+ *  @tparam AlphaNum: numérateur de alpha
+ *  @tparam AlphaDen: dénominateur de alpha, avec 1/2 < alpha < 1
+ */
+template <unsigned AlphaNum = 3, unsigned AlphaDen = 4>
+struct ScapegoatBalance
+{
+    static_assert(2 * AlphaNum > AlphaDen && AlphaNum < AlphaDen,
+                  "alpha doit être strictement compris entre 1/2 et 1");
+
+    struct NodeData
+    {
+    };
+
+    template <typename Tree, typename Node>
+    static void onInsert(Node *&r) noexcept
+    {
+        rebuildIfUnbalanced<Tree>(r);
+    }
+
+    template <typename Tree, typename Node>
+    static bool onErase(Node *&r, bool) noexcept
+    {
+        rebuildIfUnbalanced<Tree>(r);
+        return true;
+    }
+
+    template <typename Tree, typename Node>
+    static bool onUnlink(Node *, Node *&) noexcept
+    {
+        return true;
+    }
+
+    template <typename Tree, typename Node>
+    static void fixRoot(Node *) noexcept
+    {
+    }
+
+    template <typename Tree, typename Node>
+    static void onRebuild(Node *) noexcept
+    {
+    }
+
+    template <typename Tree, typename Node>
+    static int rank(const Node *) noexcept
+    {
+        return 0;
+    }
+
+    template <typename Tree, typename Node>
+    static int childRank(const Node *, int, const Node *) noexcept
+    {
+        return 0;
+    }
+
+    // r est alpha-équilibré en poids, condition de rebuildIfUnbalanced
+    template <typename Tree, typename Node>
+    static bool valid(const Node *r) noexcept
+    {
+        size_t heaviest = std::max(Tree::size(r->left), Tree::size(r->right));
+        return heaviest * AlphaDen <= r->nbElements * AlphaNum;
+    }
+
+    /**
+     * @brief m est placé le long du bord intérieur du plus gros des deux
+     *        arbres, au premier sous-arbre assez léger pour que m soit
+     *        alpha-équilibré, puis les ancêtres déséquilibrés sont
+     *        reconstruits en remontant.
+     *
+     * @remark Complexité O(log(N)) amorti
+     */
+    template <typename Tree, typename Node>
+    static Node *join(Node *l, int, Node *m, Node *r, int, int &rank) noexcept
+    {
+        rank = 0;
+        size_t n = Tree::size(l) + Tree::size(r) + 1;
+        if (Tree::size(l) * AlphaDen > n * AlphaNum)
+        {
+            l->right = join<Tree>(l->right, 0, m, r, 0, rank);
+            l->nbElements = n;
+            Tree::augment(l);
+            rebuildIfUnbalanced<Tree>(l);
+            return l;
+        }
+        if (Tree::size(r) * AlphaDen > n * AlphaNum)
+        {
+            r->left = join<Tree>(l, 0, m, r->left, 0, rank);
+            r->nbElements = n;
+            Tree::augment(r);
+            rebuildIfUnbalanced<Tree>(r);
+            return r;
+        }
+        return Tree::attach(l, m, r);
+    }
+
+private:
+    /**
+     * @brief Reconstruit le sous-arbre r s'il n'est plus alpha-équilibré
+     *        en poids
+     *
+     * @remark Complexité O(1), ou O(k) avec k = r->nbElements en cas de
+     *         reconstruction
+     */
+    template <typename Tree, typename Node>
+    static void rebuildIfUnbalanced(Node *&r) noexcept
+    {
+        size_t heaviest = std::max(Tree::size(r->left), Tree::size(r->right));
+        if (heaviest * AlphaDen > r->nbElements * AlphaNum)
+        {
+            size_t cnt = 0;
+            Node *list = nullptr;
+            Tree::linearize(r, list, cnt);
+            Tree::arborize(r, list, cnt);
+        }
+    }
+};
+
+/**
+ *  @brief Politique de traçage par défaut : aucun coût.
+ *
+ *  Une politique de traçage est notifiée de chaque construction et
+ *  destruction de noeud. enabled indique si les destructions doivent être
+ *  notifiées une à une, ce qui empêche clear() de rendre la mémoire en bloc.
+ */
+struct NoTrace
+{
+    static constexpr bool enabled = false;
+
+    template <typename K>
+    static void onConstruct(const K &) noexcept
+    {
+    }
+
+    template <typename K>
+    static void onDestroy(const K &) noexcept
+    {
+    }
+};
+
+/**
+ *  @brief Politique de traçage écrivant (Cclef) et (Dclef) sur un flux.
+ *
+ *  Le flux est cout par défaut et peut être changé par sink().
+ */
+struct StreamTrace
+{
+    static constexpr bool enabled = true;
+
+    static std::ostream *&sink() noexcept
+    {
+        static std::ostream *os = &std::cout;
+        return os;
+    }
+
+    template <typename K>
+    static void onConstruct(const K &key)
+    {
+        *sink() << "(C" << key << ") ";
+    }
+
+    template <typename K>
+    static void onDestroy(const K &key)
+    {
+        *sink() << "(D" << key << ") ";
+    }
+};
+
+/**
+ *  @brief Politique de traçage comptant les constructions et destructions
+ *         de noeuds, tous arbres confondus.
+ */
+struct CountingTrace
+{
+    static constexpr bool enabled = true;
+
+    static std::atomic<size_t> &constructed() noexcept
+    {
+        static std::atomic<size_t> n(0);
+        return n;
+    }
+
+    static std::atomic<size_t> &destroyed() noexcept
+    {
+        static std::atomic<size_t> n(0);
+        return n;
+    }
+
+    // nombre de noeuds actuellement en vie
+    static size_t live() noexcept
+    {
+        return constructed() - destroyed();
+    }
+
+    template <typename K>
+    static void onConstruct(const K &) noexcept
+    {
+        constructed().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename K>
+    static void onDestroy(const K &) noexcept
+    {
+        destroyed().fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+/**
+ *  @brief Politique d'augmentation par défaut : les noeuds ne portent que
+ *         nbElements.
+ *
+ *  Une politique d'augmentation fournit un type NodeData (hérité par chaque
+ *  noeud) et update, appelée partout où l'arbre recalcule nbElements : à la
+ *  création d'un noeud, sur le chemin d'une insertion ou d'une suppression,
+ *  dans les rotations et les jointures, et après arborize. update ne doit
+ *  pas lever d'exception.
+ */
+struct NoAugment
+{
+    static constexpr bool enabled = false;
+
+    struct NodeData
+    {
+    };
+
+    // appelée sur n dont les enfants sont à jour
+    template <typename Tree, typename Node>
+    static void update(Node *) noexcept
+    {
+    }
+};
+
+/**
+ *  @brief Monoïdes pour MonoidAugment.
+ *
+ *  Un monoïde fournit value_type, identity(), of(x) qui donne la valeur
+ *  d'un élément x, et combine(a, b), associative, dont identity() est
+ *  l'élément neutre. combine n'a pas à être commutative : les valeurs sont
+ *  toujours combinées dans l'ordre croissant des clefs.
+ */
+template <typename V>
+struct SumMonoid
+{
+    using value_type = V;
+
+    static value_type identity()
+    {
+        return value_type();
+    }
+
+    static value_type of(const V &x)
+    {
+        return x;
+    }
+
+    static value_type combine(const value_type &a, const value_type &b)
+    {
+        return a + b;
+    }
+};
+
+template <typename V>
+struct MinMonoid
+{
+    using value_type = V;
+
+    static value_type identity()
+    {
+        return std::numeric_limits<V>::max();
+    }
+
+    static value_type of(const V &x)
+    {
+        return x;
+    }
+
+    static value_type combine(const value_type &a, const value_type &b)
+    {
+        return b < a ? b : a;
+    }
+};
+
+template <typename V>
+struct MaxMonoid
+{
+    using value_type = V;
+
+    static value_type identity()
+    {
+        return std::numeric_limits<V>::lowest();
+    }
+
+    static value_type of(const V &x)
+    {
+        return x;
+    }
+
+    static value_type combine(const value_type &a, const value_type &b)
+    {
+        return a < b ? b : a;
+    }
+};
+
+// projection d'une clef sur elle-même
+struct KeyProjection
+{
+    template <typename K>
+    const K &operator()(const K &key) const noexcept
+    {
+        return key;
+    }
+};
+
+/**
+ *  @brief Politique d'augmentation maintenant dans chaque noeud la
+ *         combinaison par Monoid des valeurs de son sous-arbre, comme
+ *         nbElements en est le nombre de noeuds.
+ *
+ *  @tparam Monoid: voir SumMonoid
+ *  @tparam Projection: extrait d'une clef l'argument de Monoid::of
+ */
+template <typename Monoid, typename Projection = KeyProjection>
+struct MonoidAugment
+{
+    static constexpr bool enabled = true;
+    using value_type = typename Monoid::value_type;
+
+    struct NodeData
+    {
+        value_type aggregate = Monoid::identity(); // valeurs du sous-arbre
+    };
+
+    static value_type identity()
+    {
+        return Monoid::identity();
+    }
+
+    static value_type combine(const value_type &a, const value_type &b)
+    {
+        return Monoid::combine(a, b);
+    }
+
+    // valeur de la seule clef du noeud n
+    template <typename Node>
+    static value_type single(const Node *n)
+    {
+        return Monoid::of(Projection()(n->key));
+    }
+
+    // valeur du sous-arbre n, qui peut être nullptr
+    template <typename Node>
+    static value_type subtree(const Node *n)
+    {
+        return n ? n->aggregate : Monoid::identity();
+    }
+
+    template <typename Tree, typename Node>
+    static void update(Node *n) noexcept
+    {
+        value_type a = single(n);
+        if (n->left)
+            a = Monoid::combine(n->left->aggregate, a);
+        if (n->right)
+            a = Monoid::combine(a, n->right->aggregate);
+        n->aggregate = a;
+    }
+};
+
+/**
+ *  @brief Comparaisons à trois issues selon un ordre Compare, en un seul
+ *         appel. compare(a, b, 0) n'existe que pour les types de clefs
+ *         pour lesquels c'est possible :
+ *         - Compare fournit compare(a, b), négatif, nul ou positif ;
+ *         - Compare est std::less (ou std::less<>) et a ou b est une
+ *           chaîne, comparée par sa méthode compare.
+ */
+template <typename Compare>
+struct ThreeWay
+{
+    template <typename S>
+    struct isString : std::false_type
+    {
+    };
+
+    template <typename C, typename Tr, typename Al>
+    struct isString<std::basic_string<C, Tr, Al>> : std::true_type
+    {
+    };
+
+    template <typename C, typename Tr>
+    struct isString<std::basic_string_view<C, Tr>> : std::true_type
+    {
+    };
+
+    template <typename C>
+    struct isStdLess : std::false_type
+    {
+    };
+
+    template <typename K>
+    struct isStdLess<std::less<K>> : std::true_type
+    {
+    };
+
+    template <typename A, typename B, typename C = Compare>
+    static auto compare(const A &a, const B &b, int)
+            -> decltype(int(std::declval<const C &>().compare(a, b)))
+    {
+        return int(C().compare(a, b));
+    }
+
+    template <typename A, typename B>
+    static auto compare(const A &a, const B &b, long)
+            -> typename std::enable_if<isStdLess<Compare>::value && isString<A>::value,
+                                       decltype(int(a.compare(b)))>::type
+    {
+        return a.compare(b);
+    }
+
+    template <typename A, typename B>
+    static auto compare(const A &a, const B &b, long)
+            -> typename std::enable_if<isStdLess<Compare>::value && !isString<A>::value
+                                       && isString<B>::value, decltype(int(b.compare(a)))>::type
+    {
+        int c = b.compare(a);
+        return c < 0 ? 1 : c > 0 ? -1 : 0;
+    }
+};
+
+/**
+ *  @brief Vrai si les arguments Args d'une construction se réduisent à une
+ *         seule clef que l'ordre Compare sait comparer à T : un T, ou tout
+ *         type comparable si Compare est transparent. La position d'une
+ *         telle clef se cherche avant de construire l'élément.
+ */
+template <typename Compare, typename T, typename... Args>
+struct SingleKey : std::false_type
+{
+};
+
+template <typename Compare, typename T, typename K>
+struct SingleKey<Compare, T, K>
+{
+    template <typename C, typename = void>
+    struct isTransparent : std::false_type
+    {
+    };
+
+    template <typename C>
+    struct isTransparent<C, std::void_t<typename C::is_transparent,
+                                        decltype(C()(std::declval<const K &>(),
+                                                     std::declval<const T &>()))>>
+            : std::true_type
+    {
+    };
+
+    using type = std::integral_constant<bool, std::is_same<typename std::decay<K>::type, T>::value
+                                              || isTransparent<Compare>::value>;
+};
+
+template <typename K, typename V, typename Monoid, typename Balance, typename Compare>
+class BinarySearchMap;
+
+/**
+ *  @brief Arbre binaire de recherche d'ordre statistique.
+ *
+ *  @tparam T: type des clefs
+ *  @tparam Balance: politique d'équilibrage (NoBalance, AvlBalance,
+ *                   RedBlackBalance ou ScapegoatBalance)
+ *  @tparam Allocator: allocateur au modèle standard, utilisé pour les noeuds
+ *                     (std::allocator ou ArenaAllocator)
+ *  @tparam Tracer: politique notifiée des constructions et destructions de
+ *                  noeuds (NoTrace, StreamTrace ou CountingTrace)
+ *  @tparam Compare: ordre strict des clefs, objet fonction sans état
+ *                   construit par défaut à chaque comparaison
+ *  @tparam Augment: politique maintenant une donnée par sous-arbre en plus
+ *                   de nbElements (NoAugment ou MonoidAugment)
+ *
+ *  Chaque niveau d'une descente coûte une seule comparaison si Compare
+ *  fournit une comparaison à trois issues compare(a, b), négative, nulle ou
+ *  positive, ainsi que pour std::less (ou std::less<>) sur des chaînes, qui
+ *  utilise std::string::compare. Sinon Compare est appelé au plus deux fois.
+ *
+ *  Si Compare définit is_transparent (std::less<> par exemple), contains,
+ *  find, lower_bound, upper_bound, equal_range, count_less et rank acceptent
+ *  toute clef comparable à T sans la convertir : un
+ *  BinarySearchTree<std::string, B, A, NoTrace, std::less<>> se consulte avec
+ *  un std::string_view ou un const char *.
+ *
+ *  Si BST_STATS est défini avant l'inclusion, chaque arbre compte les
+ *  comparaisons, noeuds visités et allocations de ses opérations, par sorte
+ *  d'opération (voir operation_stats). Sinon ces compteurs n'existent pas
+ *  et ne coûtent rien.
+ */
+template <typename T, typename Balance = NoBalance,
+          typename Allocator = std::allocator<T>, typename Tracer = NoTrace,
+          typename Compare = std::less<T>, typename Augment = NoAugment>
+class BinarySearchTree
+{
+public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using key_compare = Compare;
+
+    /**
+     *  @brief Sortes d'opérations distinguées par les compteurs de BST_STATS.
+     *         Une opération appelée par une autre est comptée avec elle.
+     */
+    enum class Operation
+    {
+        Insert, // insert, emplace
+        Erase,  // deleteElement, deleteMin, extract
+        Lookup, // contains, find, lower_bound, upper_bound, count_less, aggregate,
+                // update de BinarySearchMap
+        Rank,   // rank, nth_element
+        Bulk    // lots, opérations ensemblistes, split, join, erase_range,
+                // copie
+    };
+
+    /**
+     *  @brief Compteurs cumulés d'une sorte d'opération
+     */
+    struct OperationStats
+    {
+        size_t calls = 0;       // appels
+        size_t comparisons = 0; // comparaisons de clefs
+        size_t visited = 0;     // noeuds atteints par les descentes
+        size_t allocations = 0; // noeuds alloués
+    };
+
+    /**
+     *  @brief Forme de l'arbre, calculée par stats()
+     */
+    struct Stats
+    {
+        size_t size = 0;
+        size_t height = 0;                  // nombre de niveaux, 0 si vide
+        double averageDepth = 0;            // profondeur moyenne, racine à 0
+        size_t medianDepth = 0;             // profondeurs des percentiles 50,
+        size_t p90Depth = 0;                // 90 et 99 des noeuds
+        size_t p99Depth = 0;
+        std::vector<size_t> depthHistogram; // nombre de noeuds par profondeur
+        size_t bytes = 0;                   // objet arbre et noeuds
+    };
+
+private:
+    /**
+     *  @brief Noeud de l'arbre.
+     *
+     * contient une clef et les liens vers les sous-arbres droit et gauche,
+     * ainsi que les données propres aux politiques d'équilibrage et
+     * d'augmentation.
+     */
+    struct Node : Balance::NodeData, Augment::NodeData
+    {
+        const value_type key; // clef non modifiable
+        Node *right;          // sous arbre avec des clefs plus grandes
+        Node *left;           // sous arbre avec des clefs plus petites
+        size_t nbElements;    // nombre de noeuds dans le sous-arbre dont
+                              // ce noeud est la racine
+
+        Node(const_reference key) // key est obligatoire
+                : key(key), right(nullptr), left(nullptr), nbElements(1)
+        {
+        }
+
+        // clef construite sur place à partir de args
+        template <typename... Args>
+        Node(std::in_place_t, Args &&... args)
+                : key(std::forward<Args>(args)...), right(nullptr), left(nullptr), nbElements(1)
+        {
+        }
+        Node() = delete;             // pas de construction par défaut
+        Node(const Node &) = delete; // pas de construction par copie
+        Node(Node &&) = delete;      // pas de construction par déplacement
+    };
+
+    /**
+     * Racine de l'arbre. Nullptr si l'arbre est vide.
+     */
+    Node *_root;
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    /**
+     * Allocateur des noeuds, échangé avec la racine par swap.
+     */
+    NodeAllocator _alloc;
+
+    friend Balance;
+
+    template <typename, typename, typename, typename, typename>
+    friend class BinarySearchMap;
+
+#ifdef BST_STATS
+    // compteurs d'une sorte d'opération, incrémentés aussi par les méthodes
+    // constantes, éventuellement depuis plusieurs threads
+    struct Counters
+    {
+        std::atomic<size_t> calls{0};
+        std::atomic<size_t> comparisons{0};
+        std::atomic<size_t> visited{0};
+        std::atomic<size_t> allocations{0};
+    };
+
+    /**
+     * Compteurs par sorte d'opération, propres à l'arbre : ni copiés ni
+     * échangés.
+     */
+    mutable Counters _counters[size_t(Operation::Bulk) + 1];
+
+    // compteurs de l'opération en cours dans ce thread, nullptr hors opération
+    static Counters *&currentCounters() noexcept
+    {
+        static thread_local Counters *current = nullptr;
+        return current;
+    }
+#endif
+
+    /**
+     * @brief Désigne, le temps d'une opération publique, les compteurs de
+     *        l'arbre que les fonctions count* incrémentent dans le thread
+     *        courant. Une opération imbriquée reste comptée avec la
+     *        première. Sans BST_STATS, ne fait rien.
+     */
+    class OperationScope
+    {
+#ifdef BST_STATS
+        Counters *previous;
+#endif
+
+    public:
+        // opération en cours dans le thread qui le construit, à transmettre
+        // aux tâches qu'elle confie à la réserve de threads
+        struct Context
+        {
+#ifdef BST_STATS
+            Counters *counters = currentCounters();
+#endif
+        };
+
+        OperationScope(const BinarySearchTree &tree, Operation op) noexcept
+        {
+#ifdef BST_STATS
+            previous = currentCounters();
+            if(previous == nullptr){
+                currentCounters() = &tree._counters[size_t(op)];
+                currentCounters()->calls.fetch_add(1, std::memory_order_relaxed);
+            }
+#else
+            (void)tree;
+            (void)op;
+#endif
+        }
+
+        // compte le travail d'une tâche avec l'opération qui l'a créée, sans
+        // compter un appel de plus
+        explicit OperationScope(const Context &context) noexcept
+        {
+#ifdef BST_STATS
+            previous = currentCounters();
+            if(previous == nullptr){
+                currentCounters() = context.counters;
+            }
+#else
+            (void)context;
+#endif
+        }
+
+        ~OperationScope()
+        {
+#ifdef BST_STATS
+            currentCounters() = previous;
+#endif
+        }
+
+        OperationScope(const OperationScope &) = delete;
+        OperationScope &operator=(const OperationScope &) = delete;
+    };
+
+    static void countComparison() noexcept
+    {
+#ifdef BST_STATS
+        if(Counters *c = currentCounters())
+            c->comparisons.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
+    static void countVisit() noexcept
+    {
+#ifdef BST_STATS
+        if(Counters *c = currentCounters())
+            c->visited.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
+    static void countAllocation() noexcept
+    {
+#ifdef BST_STATS
+        if(Counters *c = currentCounters())
+            c->allocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
+    // comparaison de deux clefs, comptée avec BST_STATS. a ou b peut être
+    // une clef d'un autre type si Compare est transparent
+    template <typename A, typename B>
+    static bool less(const A &a, const B &b)
+    {
+        countComparison();
+        return Compare()(a, b);
+    }
+
+    // vrai si la comparaison d'un A et d'un B ne peut lever d'exception
+    template <typename A, typename B>
+    static constexpr bool nothrowLess() noexcept
+    {
+        return noexcept(Compare()(std::declval<const A &>(), std::declval<const B &>()));
+    }
+
+    // vrai si compare(a, b), qui compare dans les deux sens, ne peut lever
+    template <typename A, typename B>
+    static constexpr bool nothrowCompare() noexcept
+    {
+        return nothrowLess<A, B>() && nothrowLess<B, A>();
+    }
+
+    // comparaison en un appel, si Compare en fournit une pour A et B
+    template <typename A, typename B>
+    static auto threeWay(const A &a, const B &b, int)
+            -> decltype(ThreeWay<Compare>::compare(a, b, 0))
+    {
+        countComparison();
+        return ThreeWay<Compare>::compare(a, b, 0);
+    }
+
+    // sinon deux appels à Compare au plus
+    template <typename A, typename B>
+    static int threeWay(const A &a, const B &b, ...)
+    {
+        return less(a, b) ? -1 : less(b, a) ? 1 : 0;
+    }
+
+    /**
+     * @brief Comparaison à trois issues de deux clefs
+     *
+     * @return Négatif si a précède b, positif si b précède a, 0 si elles
+     *         sont équivalentes
+     */
+    template <typename A, typename B>
+    static int compare(const A &a, const B &b)
+    {
+        return threeWay(a, b, 0);
+    }
+
+private:
+    /**
+     *  @brief Chemin de la racine à un noeud, utilisé comme une pile
+     *
+     *  Les Inline premiers noeuds sont rangés dans l'objet lui-même, ce qui
+     *  suffit à un arbre équilibré de plusieurs millions de clefs : copier
+     *  un itérateur n'alloue alors rien. Seuls les noeuds plus profonds,
+     *  ceux d'un arbre dégénéré, sont rangés dans un vecteur.
+     */
+    class Path
+    {
+        static constexpr size_t Inline = 32;
+
+        const Node *nodes[Inline] = {};
+        std::vector<const Node *> deeper; // noeuds au-delà des Inline premiers
+        size_t depth = 0;
+
+    public:
+        bool empty() const noexcept
+        {
+            return depth == 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return depth;
+        }
+
+        const Node *back() const noexcept
+        {
+            return depth > Inline ? deeper.back() : nodes[depth - 1];
+        }
+
+        void push_back(const Node *n)
+        {
+            if (depth < Inline)
+                nodes[depth] = n;
+            else
+                deeper.push_back(n);
+            ++depth;
+        }
+
+        void pop_back() noexcept
+        {
+            if (depth > Inline)
+                deeper.pop_back();
+            --depth;
+        }
+
+        // ne garde que les n premiers noeuds, n <= size()
+        void resize(size_t n) noexcept
+        {
+            while (depth > n)
+                pop_back();
+        }
+    };
+
+public:
+    /**
+     *  @brief Itérateur bidirectionnel constant, parcourt les clefs par ordre
+     *         croissant.
+     *
+     *  Mémorise le chemin depuis la racine jusqu'au noeud courant, ce qui
+     *  permet d'avancer et de reculer sans pointeur vers le parent. Un pas
+     *  coûte O(1) amorti. Toute modification de l'arbre invalide les
+     *  itérateurs.
+     */
+    class const_iterator
+    {
+        friend class BinarySearchTree;
+
+        const Node *root; // racine de l'arbre parcouru
+        Path path;        // chemin vers le noeud courant, vide pour end()
+
+        const_iterator(const Node *root) : root(root)
+        {
+        }
+
+        // descend à gauche depuis le noeud courant jusqu'au minimum
+        void descendLeft()
+        {
+            while (path.back()->left)
+                path.push_back(path.back()->left);
+        }
+
+        // descend à droite depuis le noeud courant jusqu'au maximum
+        void descendRight()
+        {
+            while (path.back()->right)
+                path.push_back(path.back()->right);
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : root(nullptr)
+        {
+        }
+
+        reference operator*() const
+        {
+            return path.back()->key;
+        }
+
+        pointer operator->() const
+        {
+            return &path.back()->key;
+        }
+
+        const_iterator &operator++()
+        {
+            const Node *n = path.back();
+            if (n->right)
+            {
+                path.push_back(n->right);
+                descendLeft();
+            }
+            else
+            {
+                // remonte tant que l'on vient d'un sous-arbre droit
+                do
+                {
+                    n = path.back();
+                    path.pop_back();
+                } while (!path.empty() && path.back()->right == n);
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator &operator--()
+        {
+            if (path.empty())
+            {
+                // --end() : élément maximal
+                if (root)
+                {
+                    path.push_back(root);
+                    descendRight();
+                }
+                return *this;
+            }
+            const Node *n = path.back();
+            if (n->left)
+            {
+                path.push_back(n->left);
+                descendRight();
+            }
+            else
+            {
+                do
+                {
+                    n = path.back();
+                    path.pop_back();
+                } while (!path.empty() && path.back()->left == n);
+            }
+            return *this;
+        }
+
+        const_iterator operator--(int)
+        {
+            const_iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const noexcept
+        {
+            return path.empty() ? other.path.empty()
+                                : !other.path.empty() && path.back() == other.path.back();
+        }
+
+        bool operator!=(const const_iterator &other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+
+    using iterator = const_iterator; // les clefs ne sont pas modifiables
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reverse_iterator = const_reverse_iterator;
+
+    /**
+     *  @brief Constructeur par défaut. Construit un arbre vide
+     */
+    BinarySearchTree() : _root(nullptr)
+    {
+    }
+
+    /**
+     *  @brief Construit un arbre vide utilisant l'allocateur donné
+     *
+     *  @param alloc: allocateur des noeuds
+     */
+    explicit BinarySearchTree(const Allocator &alloc)
+            : _root(nullptr), _alloc(alloc)
+    {
+    }
+
+    /**
+     *  @brief Construit un arbre équilibré contenant les clefs d'une séquence
+     *
+     *  @param first, last: séquence de clefs, les doublons sont ignorés
+     *  @param alloc: allocateur des noeuds
+     *
+     *  @remark Complexité O(N) si la séquence est triée et parcourable
+     *          plusieurs fois, O(N log(N)) sinon (tri dans un tampon).
+     */
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    BinarySearchTree(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+            : _root(nullptr), _alloc(alloc)
+    {
+        assignRange(first, last,
+                    typename std::iterator_traits<InputIt>::iterator_category());
+    }
+
+    /**
+     *  @brief Constucteur de copie
+     *
+     *  @param other: le BinarySearchTree à copier
+     *
+     *  @remark Complexité : O(N). Les other.size() noeuds sont demandés
+     *          d'un bloc à l'allocateur s'il le permet (ArenaAllocator).
+     *          Un grand arbre non tracé dont l'allocateur est sans état est
+     *          copié en parallèle, par sous-arbres. Avec BST_STATS, la copie
+     *          est comptée comme une opération Bulk du nouvel arbre, ou avec
+     *          l'opération qui l'appelle, noeuds alloués par les autres
+     *          threads compris.
+     */
+    BinarySearchTree(const BinarySearchTree &other)
+            : _root(nullptr),
+              _alloc(NodeTraits::select_on_container_copy_construction(other._alloc))
+    {
+        if (other._root)
+        {
+            OperationScope scope(*this, Operation::Bulk);
+            reserveNodes(_alloc, other.size(), 0);
+            //On essaye d'effectuer la copie
+            try{
+                _root = newNode(other._root->key);
+                if(useParallel(other.size())){
+                    // le groupe attend ses tâches avant que le catch ne
+                    // libère ce qu'elles ont construit
+                    TaskGroup group(WorkStealingPool::instance());
+                    copyTree(other._root, _root, &group);
+                    group.wait();
+                }else{
+                    copyTree(other._root, _root);
+                }
+            }
+            //Si la copie n'a pas reussi, 
+            //on supprime ce qui a été créé pendant l'essai
+            catch (...)
+            {
+                deleteSubTree(_root);
+                _root = nullptr;
+                throw;
+            }
+        }
+    }
+
+    /**
+     *  @brief Opérateur d'affectation par copie
+     *
+     *  @param other: Le BinarySearchTree (BST) à copier
+     * 
+     *  @remark Complexié O(N) avec N le nombre de sous arbres. L'arbre n'est
+     *          pas modifié si la copie échoue. Avec BST_STATS, la copie est
+     *          comptée comme une opération Bulk de cet arbre.
+     */
+    BinarySearchTree &operator=(const BinarySearchTree &other)
+    {
+        if(this != &other){
+            OperationScope scope(*this, Operation::Bulk);
+            BinarySearchTree copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    /**
+     *  @brief Echange le contenu avec un autre BST
+     *
+     *  @param other: le BST avec lequel on echange le contenu
+     *
+     *  @remark Complexité O(1)
+     */
+    void swap(BinarySearchTree &other) noexcept
+    {
+        if(_root != other._root){
+            Node *temp = _root;
+            _root = other._root;
+            other._root = temp;
+        }
+        using std::swap;
+        swap(_alloc, other._alloc);
+    }
+
+    /**
+     *  @brief Constructeur de copie par déplacement
+     *
+     *  @param other: le BST dont on vole le contenu
+     *
+     *  @remark Complexité O(1)
+     */
+    BinarySearchTree(BinarySearchTree &&other) noexcept
+            : _root(other._root), _alloc(std::move(other._alloc))
+    {
+        other._root = nullptr;
+    }
+
+    /**
+     *  @brief Opérateur d'affectation par déplacement
+     *
+     *  @param other: le BST dont on vole le contenu
+     *
+     *  @remark Complexité O(1), plus la destruction de l'ancien contenu
+     */
+    BinarySearchTree &operator=(BinarySearchTree &&other) noexcept
+    {
+        if(this != &other){
+            BinarySearchTree moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+    /**
+     *  @brief Destructeur
+     * 
+     *  @remark Complexité O(N) avec N le nombre de noeuds dans l'arbre, O(1)
+     *          si clear() peut rendre la mémoire des noeuds en bloc
+     */
+    ~BinarySearchTree()
+    {
+        clear();
+    }
+
+    /**
+     *  @brief Supprime tous les éléments de l'arbre
+     *
+     *  @remark Complexité O(N). Si les noeuds n'ont rien à détruire, que le
+     *          traçage est désactivé et que l'allocateur possède seul sa
+     *          mémoire (ArenaAllocator), elle est rendue en bloc, en O(1) par
+     *          rapport à N.
+     */
+    void clear() noexcept
+    {
+        if(!(std::is_trivially_destructible<Node>::value && !Tracer::enabled
+             && releaseNodes(_alloc, 0))){
+            deleteSubTree(_root);
+        }
+        _root = nullptr;
+    }
+
+    /**
+     *  @brief Remplace le contenu de l'arbre par les clefs d'une séquence
+     *
+     *  @param first, last: séquence de clefs, les doublons sont ignorés
+     *
+     *  @remark Complexité O(N) si la séquence est triée et parcourable
+     *          plusieurs fois, O(N log(N)) sinon. L'arbre n'est pas modifié
+     *          en cas d'exception.
+     */
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first, InputIt last)
+    {
+        BinarySearchTree tree(first, last, Allocator(_alloc));
+        swap(tree);
+    }
+
+    /**
+     *  @brief Insertion d'un lot de clefs triées
+     *
+     *  Un lot grand par rapport à l'arbre est fusionné en une passe : les
+     *  noeuds du lot sont d'abord tous créés, puis l'arbre est linéarisé,
+     *  fusionné avec eux et arborisé. Un petit lot, ou un lot non trié, est
+     *  inséré clef par clef. Le choix se fait en comparant M log(N) à 4 (N + M).
+     *
+     *  @param first, last: séquence de M clefs, les doublons sont ignorés
+     *
+     *  @remark Complexité O(min(M log(N + M), N + M)). Lors d'une fusion,
+     *          l'arbre n'est pas modifié en cas d'exception ; clef par clef,
+     *          les clefs déjà insérées le restent.
+     */
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert_sorted_batch(InputIt first, InputIt last)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        insertBatch(first, last,
+                    typename std::iterator_traits<InputIt>::iterator_category());
+    }
+
+    /**
+     *  @brief Ajoute à l'arbre les clefs de other
+     *
+     *  Si other est petit, ses clefs sont insérées une à une, sinon les
+     *  noeuds des clefs absentes sont créés puis fusionnés avec l'arbre
+     *  linéarisé (voir insert_sorted_batch).
+     *
+     *  @remark Complexité O(min(M log(N + M), N + M)). Lors d'une fusion,
+     *          l'arbre n'est pas modifié en cas d'exception.
+     */
+    void set_union_with(const BinarySearchTree &other)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        if(this == &other){
+            return;
+        }
+        if(perKeyCheaper(other.size(), size())){
+            for(const_reference key : other){
+                insert(key);
+            }
+            return;
+        }
+        Node *list = nullptr;
+        Node *tail = nullptr;
+        size_t cnt = 0;
+        try{
+            const_iterator it = begin();
+            for(const_reference key : other){
+                while(it != end() && less(*it, key)){
+                    ++it;
+                }
+                if(it != end() && !less(key, *it)){
+                    continue;
+                }
+                Node *node = newNode(key);
+                (tail ? tail->right : list) = node;
+                tail = node;
+                ++cnt;
+            }
+        }catch(...){
+            deleteSubTree(list);
+            throw;
+        }
+        mergeList(list, cnt);
+    }
+
+    /**
+     *  @brief Ajoute à l'arbre les clefs de other en réutilisant ses noeuds.
+     *         other est vide ensuite.
+     *
+     *  Le plus grand des deux arbres reçoit les clefs de l'autre, par
+     *  fusion de leurs listes linéarisées ou, si l'autre est petit, par
+     *  split et join le long de ses noeuds. Si les allocateurs diffèrent,
+     *  les clefs sont copiées.
+     *
+     *  @remark Complexité O(min(m log(n / m + 1), N + M)) avec m et n les
+     *          tailles du plus petit et du plus grand arbre
+     */
+    void set_union_with(BinarySearchTree &&other)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        if(this == &other){
+            return;
+        }
+        if(_alloc != other._alloc){
+            set_union_with(static_cast<const BinarySearchTree &>(other));
+            other.clear();
+            return;
+        }
+        if(size() < other.size()){
+            swap(other);
+        }
+        if(perKeyCheaper(other.size(), size())){
+            int rank;
+            _root = unite(_root, joinRank(_root), other._root, joinRank(other._root), rank);
+            other._root = nullptr;
+            Balance::template fixRoot<BinarySearchTree>(_root);
+            return;
+        }
+        size_t cnt = 0;
+        Node *list = nullptr;
+        linearize(other._root, list, cnt);
+        other._root = nullptr;
+        mergeList(list, cnt);
+    }
+
+    /**
+     *  @brief Ne garde dans l'arbre que les clefs présentes dans other
+     *
+     *  Les deux arbres sont parcourus ensemble par ordre croissant ou, si
+     *  l'arbre est petit, chacune de ses clefs est cherchée dans other.
+     *
+     *  @remark Complexité O(min(N log(M), N + M)). En cas d'exception d'une
+     *          comparaison, une partie des clefs a pu être retirée.
+     */
+    void set_intersection_with(const BinarySearchTree &other)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        if(this == &other){
+            return;
+        }
+        if(perKeyCheaper(size(), other.size())){
+            filter([&other](const_reference key) { return other.contains(key); });
+        }else{
+            const_iterator it = other.begin(), last = other.end();
+            filter([&it, &last](const_reference key) {
+                while(it != last && less(*it, key)){
+                    ++it;
+                }
+                return it != last && !less(key, *it);
+            });
+        }
+    }
+
+    /**
+     *  @brief Retire de l'arbre les clefs présentes dans other
+     *
+     *  Si other est petit, ses clefs sont supprimées une à une, sinon les
+     *  deux arbres sont parcourus ensemble ou, si l'arbre est petit,
+     *  chacune de ses clefs est cherchée dans other.
+     *
+     *  @remark Complexité O(min(M log(N), N log(M), N + M)). En cas
+     *          d'exception d'une comparaison, une partie des clefs a pu
+     *          être retirée.
+     */
+    void set_difference_with(const BinarySearchTree &other)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        if(this == &other){
+            clear();
+        }else if(perKeyCheaper(other.size(), size())){
+            for(const_reference key : other){
+                deleteElement(key);
+            }
+        }else if(perKeyCheaper(size(), other.size())){
+            filter([&other](const_reference key) { return !other.contains(key); });
+        }else{
+            const_iterator it = other.begin(), last = other.end();
+            filter([&it, &last](const_reference key) {
+                while(it != last && less(*it, key)){
+                    ++it;
+                }
+                return it == last || less(key, *it);
+            });
+        }
+    }
+
+    /**
+     *  @brief Sépare l'arbre en deux arbres : les clefs inférieures à key
+     *         et les autres. L'arbre est vidé, ses noeuds sont déplacés.
+     *
+     *  @param key: Clef de séparation, présente ou non dans l'arbre
+     *
+     *  @return La paire (clefs < key, clefs >= key)
+     *
+     *  @remark Complexité O(log(N)) pour AVL et rouge-noir, O(h) sinon avec
+     *          h la hauteur de l'arbre. Aucun noeud n'est alloué ni copié.
+     *          La position de key est cherchée avant toute modification :
+     *          si Compare lève une exception, l'arbre n'est pas modifié.
+     */
+    std::pair<BinarySearchTree, BinarySearchTree> split(const_reference key)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        size_t n = countLess(key);
+        std::pair<BinarySearchTree, BinarySearchTree> parts{sharingAllocator(),
+                                                            sharingAllocator()};
+        splitInto(rankPosition(n), parts.first._root, parts.second._root);
+        return parts;
+    }
+
+    /**
+     *  @brief Sépare l'arbre en deux arbres : les n plus petites clefs et
+     *         les autres. L'arbre est vidé, ses noeuds sont déplacés.
+     *
+     *  @param n: Nombre de clefs du premier arbre, borné par size()
+     *
+     *  @return La paire (clefs de rang < n, clefs de rang >= n)
+     *
+     *  @remark Complexité O(log(N)) pour AVL et rouge-noir, O(h) sinon
+     */
+    std::pair<BinarySearchTree, BinarySearchTree> split_at_rank(size_t n)
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        std::pair<BinarySearchTree, BinarySearchTree> parts{sharingAllocator(),
+                                                            sharingAllocator()};
+        splitInto(rankPosition(n), parts.first._root, parts.second._root);
+        return parts;
+    }
+
+    /**
+     *  @brief Supprime les clefs de l'intervalle [lo, hi[
+     *
+     *  Le sous-arbre des clefs de l'intervalle est détaché par deux split
+     *  et les deux bords sont réunis par join : seuls les noeuds des
+     *  chemins vers lo et hi sont modifiés, puis les noeuds détachés sont
+     *  libérés d'un coup.
+     *
+     *  @param lo: Borne inférieure incluse
+     *  @param hi: Borne supérieure exclue
+     *  @param background: Si vrai, un grand nombre de noeuds retirés est
+     *                     libéré par la réserve de threads, lorsque
+     *                     l'allocateur est sans état et le traçage désactivé.
+     *                     T doit alors pouvoir être détruit depuis un autre
+     *                     thread.
+     *
+     *  @return Le nombre de clefs supprimées
+     *
+     *  @remark Complexité O(log(N) + k) avec k le nombre de clefs supprimées,
+     *          O(log(N)) pour AVL et rouge-noir si elles sont libérées en
+     *          arrière-plan. Les rangs de lo et hi sont cherchés avant toute
+     *          modification : si Compare lève une exception, l'arbre n'est
+     *          pas modifié.
+     */
+    size_t erase_range(const_reference lo, const_reference hi,
+                       bool background = false) noexcept(nothrowLess<T, T>())
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        if(!less(lo, hi)){
+            return 0;
+        }
+        size_t i = countLess(lo);
+        size_t j = countLess(hi);
+        return eraseBetween(rankPosition(i), rankPosition(j - i), background);
+    }
+
+    /**
+     *  @brief Supprime les clefs de rang compris dans [i, j[
+     *
+     *  @param i: Premier rang supprimé
+     *  @param j: Rang suivant le dernier rang supprimé, borné par size()
+     *  @param background: Voir erase_range
+     *
+     *  @return Le nombre de clefs supprimées
+     *
+     *  @remark Complexité O(log(N) + k) avec k = j - i, O(log(N)) pour AVL
+     *          et rouge-noir si les clefs sont libérées en arrière-plan
+     */
+    size_t erase_ranks(size_t i, size_t j, bool background = false) noexcept
+    {
+        OperationScope scope(*this, Operation::Bulk);
+        j = std::min(j, size());
+        if(i >= j){
+            return 0;
+        }
+        return eraseBetween(rankPosition(i), rankPosition(j - i), background);
+    }
+
+    /**
+     *  @brief Concatène deux arbres dont toutes les clefs de left sont
+     *         inférieures à celles de right. Les deux arbres sont vidés.
+     *
+     *  @exception std::invalid_argument si les intervalles de clefs se
+     *             chevauchent, les arbres ne sont alors pas modifiés
+     *
+     *  @remark Complexité O(log(N)) pour AVL et rouge-noir, O(h) sinon.
+     *          Si les allocateurs diffèrent, les clefs de right sont copiées
+     *          en O(M log(N + M)).
+     */
+    static BinarySearchTree join(BinarySearchTree &&left, BinarySearchTree &&right)
+    {
+        OperationScope scope(left, Operation::Bulk);
+        if(left._root && right._root){
+            const Node *max = left._root;
+            while(max->right){
+                max = max->right;
+            }
+            if(!less(max->key, minNode(right._root)->key)){
+                throw std::invalid_argument("Les clefs des deux arbres se chevauchent");
+            }
+        }
+        BinarySearchTree result(std::move(left));
+        if(result._alloc != right._alloc){
+            result.set_union_with(std::move(right));
+            return result;
+        }
+        int rank;
+        result._root = join(result._root, joinRank(result._root),
+                            right._root, joinRank(right._root), rank);
+        right._root = nullptr;
+        Balance::template fixRoot<BinarySearchTree>(result._root);
+        return result;
+    }
+
+private:
+    /**
+     * @brief Arbre vide utilisant une copie de l'allocateur des noeuds,
+     *        donc la même mémoire (arène d'ArenaAllocator comprise) : il
+     *        peut recevoir des noeuds de cet arbre
+     */
+    BinarySearchTree sharingAllocator() const
+    {
+        BinarySearchTree tree;
+        tree._alloc = _alloc;
+        return tree;
+    }
+
+    /**
+     * @brief Alloue et construit un noeud
+     *
+     * @param args: arguments du constructeur de Node, la clef ou
+     *              std::in_place suivi des arguments du constructeur de T
+     *
+     * @exception Celles de l'allocateur et du constructeur de T.
+     *            Rien n'est alloué en cas d'exception.
+     */
+    template <typename... Args>
+    Node *newNode(Args &&... args)
+    {
+        Node *n = NodeTraits::allocate(_alloc, 1);
+        countAllocation();
+        try{
+            NodeTraits::construct(_alloc, n, std::forward<Args>(args)...);
+        }catch(...){
+            NodeTraits::deallocate(_alloc, n, 1);
+            throw;
+        }
+        Tracer::onConstruct(n->key);
+        augment(n);
+        return n;
+    }
+
+    /**
+     * @brief Détruit et désalloue un noeud
+     */
+    void deleteNode(Node *n) noexcept
+    {
+        Tracer::onDestroy(n->key);
+        NodeTraits::destroy(_alloc, n);
+        NodeTraits::deallocate(_alloc, n, 1);
+    }
+
+    /**
+     * @brief Construit l'arbre à partir d'une séquence parcourable plusieurs
+     *        fois, directement si elle est déjà triée
+     *
+     * @remark Complexité O(N) si la séquence est triée, O(N log(N)) sinon
+     */
+    template <typename ForwardIt>
+    void assignRange(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+    {
+        if(std::is_sorted(first, last, Compare())){
+            buildSorted(first, last, size_t(std::distance(first, last)));
+        }else{
+            assignRange(first, last, std::input_iterator_tag());
+        }
+    }
+
+    /**
+     * @brief Construit l'arbre à partir d'une séquence quelconque, triée
+     *        dans un tampon
+     *
+     * @remark Complexité O(N log(N))
+     */
+    template <typename InputIt>
+    void assignRange(InputIt first, InputIt last, std::input_iterator_tag)
+    {
+        std::vector<value_type> keys(first, last);
+        std::sort(keys.begin(), keys.end(), Compare());
+        buildSorted(keys.begin(), keys.end(), keys.size());
+    }
+
+    /**
+     * @brief Construit un arbre parfaitement équilibré à partir d'une
+     *        séquence triée
+     *
+     * Les noeuds sont alloués d'un bloc puis chainés par leur pointeur right
+     * comme après linearize, et arborize les met en place. L'arbre doit être
+     * vide.
+     *
+     * @param first, last: séquence triée, les doublons consécutifs sont ignorés
+     * @param n: nombre d'éléments de la séquence
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename ForwardIt>
+    void buildSorted(ForwardIt first, ForwardIt last, size_t n)
+    {
+        assert(_root == nullptr);
+        size_t cnt = 0;
+        Node *list = makeList(first, last, n, cnt);
+        arborize(_root, list, cnt);
+        Balance::template onRebuild<BinarySearchTree>(_root);
+    }
+
+    /**
+     * @brief Crée les noeuds d'une séquence triée, chainés par leur pointeur
+     *        right comme après linearize
+     *
+     * @param first, last: séquence triée, les doublons consécutifs sont ignorés
+     * @param n: nombre d'éléments de la séquence, réservés d'un bloc
+     * @param cnt: reçoit le nombre de noeuds créés
+     *
+     * @return La tête de la liste. Rien n'est alloué en cas d'exception.
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename ForwardIt>
+    Node *makeList(ForwardIt first, ForwardIt last, size_t n, size_t &cnt)
+    {
+        reserveNodes(_alloc, n, 0);
+        Node *list = nullptr;
+        Node *tail = nullptr;
+        cnt = 0;
+        try{
+            for(; first != last; ++first){
+                if(tail && !less(tail->key, *first)){
+                    continue;
+                }
+                Node *node = newNode(*first);
+                (tail ? tail->right : list) = node;
+                tail = node;
+                ++cnt;
+            }
+        }catch(...){
+            deleteSubTree(list);
+            throw;
+        }
+        return list;
+    }
+
+    /**
+     * @brief Insertion d'un lot parcourable plusieurs fois, par fusion ou
+     *        clef par clef selon sa taille
+     */
+    template <typename ForwardIt>
+    void insertBatch(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+    {
+        size_t m = size_t(std::distance(first, last));
+        if(perKeyCheaper(m, size()) || !std::is_sorted(first, last, Compare())){
+            for(; first != last; ++first){
+                insert(*first);
+            }
+            return;
+        }
+        size_t cnt = 0;
+        Node *batch = makeList(first, last, m, cnt);
+        mergeList(batch, cnt);
+    }
+
+    /**
+     * @brief Indique si m opérations clef par clef, par ordre croissant,
+     *        sur un arbre de n clefs coûtent moins qu'une fusion en O(n + m)
+     *
+     * Un niveau de descente, dont les chemins successifs restent en cache,
+     * coûte environ le quart du passage d'un noeud dans la fusion : on
+     * compare m log2(n + 1) à 4 (n + m).
+     */
+    static bool perKeyCheaper(size_t m, size_t n) noexcept
+    {
+        size_t lg = 0;
+        for(size_t k = n + 1; k > 1; k >>= 1){
+            ++lg;
+        }
+        return m * lg < 4 * (n + m);
+    }
+
+    /**
+     * @brief Insertion d'un lot quelconque, copié dans un tampon
+     */
+    template <typename InputIt>
+    void insertBatch(InputIt first, InputIt last, std::input_iterator_tag)
+    {
+        std::vector<value_type> keys(first, last);
+        insertBatch(keys.begin(), keys.end(), std::forward_iterator_tag());
+    }
+
+    /**
+     * @brief Fusionne une liste triée de noeuds avec ceux de l'arbre
+     *
+     * @param batch: liste de noeuds chainés par right, sans doublon. Les
+     *               noeuds dont la clef est déjà dans l'arbre sont détruits.
+     * @param cnt: nombre de noeuds de la liste
+     *
+     * @remark Complexité O(N + M). Reste noexcept même si Compare peut
+     *         lever : l'arbre est linéarisé pendant les comparaisons et ne
+     *         pourrait être rendu dans un état valide.
+     */
+    void mergeList(Node *batch, size_t cnt) noexcept
+    {
+        Node *list = nullptr;
+        linearize(_root, list, cnt);
+        Node *merged = nullptr;
+        Node **end = &merged;
+        while(list && batch){
+            int c = compare(batch->key, list->key);
+            if(c < 0){
+                *end = batch;
+                batch = batch->right;
+            }else{
+                if(c == 0){
+                    Node *dup = batch;
+                    batch = batch->right;
+                    deleteNode(dup);
+                    --cnt;
+                }
+                *end = list;
+                list = list->right;
+            }
+            end = &(*end)->right;
+        }
+        *end = list ? list : batch;
+        arborize(_root, merged, cnt);
+        Balance::template onRebuild<BinarySearchTree>(_root);
+    }
+
+    /**
+     * @brief Ne garde que les clefs pour lesquelles keep(key) est vrai
+     *
+     * keep est appelé sur chaque clef par ordre croissant. L'arbre est
+     * linéarisé, les noeuds rejetés sont détruits et les autres arborisés.
+     * Si keep lève une exception, les noeuds non encore examinés sont
+     * gardés.
+     *
+     * @remark Complexité O(N) plus les appels à keep
+     */
+    template <typename Keep>
+    void filter(Keep keep)
+    {
+        size_t cnt = 0;
+        Node *list = nullptr;
+        linearize(_root, list, cnt);
+        Node *kept = nullptr;
+        Node **end = &kept;
+        try{
+            while(list){
+                if(keep(list->key)){
+                    *end = list;
+                    end = &list->right;
+                    list = list->right;
+                }else{
+                    Node *n = list;
+                    list = list->right;
+                    deleteNode(n);
+                    --cnt;
+                }
+            }
+        }catch(...){
+            *end = list;
+            arborize(_root, kept, cnt);
+            Balance::template onRebuild<BinarySearchTree>(_root);
+            throw;
+        }
+        *end = nullptr;
+        arborize(_root, kept, cnt);
+        Balance::template onRebuild<BinarySearchTree>(_root);
+    }
+
+    // appelle alloc.reserve(n) si l'allocateur le propose
+    template <typename A>
+    static auto reserveNodes(A &alloc, size_t n, int) -> decltype(alloc.reserve(n), void())
+    {
+        alloc.reserve(n);
+    }
+
+    template <typename A>
+    static void reserveNodes(A &, size_t, long)
+    {
+    }
+
+    // appelle alloc.release() si l'allocateur le propose
+    template <typename A>
+    static auto releaseNodes(A &alloc, int) noexcept -> decltype(alloc.release())
+    {
+        return alloc.release();
+    }
+
+    template <typename A>
+    static bool releaseNodes(A &, long) noexcept
+    {
+        return false;
+    }
+
+    // taille des sous-arbres confiés à une même tâche par la copie et
+    // l'équilibrage parallèles
+    static size_t parallelGrain() noexcept
+    {
+        return 4096;
+    }
+
+    /**
+     * @brief Indique si la copie ou l'équilibrage de n noeuds se fait en
+     *        parallèle : l'arbre doit être grand, la réserve de threads en
+     *        compter plusieurs, l'allocateur être sans état, pour pouvoir
+     *        être appelé depuis plusieurs threads, et le traçage désactivé,
+     *        pour que les traces ne s'entremêlent pas sur un même flux.
+     */
+    static bool useParallel(size_t n)
+    {
+        return std::is_empty<NodeAllocator>::value && !Tracer::enabled &&
+               n >= 4 * parallelGrain() &&
+               WorkStealingPool::instance().size() > 1;
+    }
+
+    // soumet f au groupe, ou l'exécute directement si la soumission échoue
+    template <typename Fn>
+    static void spawn(TaskGroup &group, Fn f) noexcept
+    {
+        try{
+            group.run(f);
+        }catch(...){
+            f();
+        }
+    }
+
+    /**
+     * @brief Copie un BTS dans un autre.
+     *
+     * @param src: Racine du BTS a copier.
+     * @param dest: Racine du BTS copié.
+     * @param group: Si non nul, les sous-arbres d'au plus parallelGrain()
+     *               noeuds sont copiés par des tâches de ce groupe, qu'il
+     *               faut attendre avant d'utiliser ou de libérer dest.
+     *
+     * @remark Complexité : O(N) avec N le nombre de noeuds dans src
+     */
+    void copyTree(const Node* src, Node* dest, TaskGroup *group = nullptr){
+        // noeuds source restant à copier et emplacement de leur copie. Chaque
+        // copie est reliée dès sa création, deleteSubTree(dest) libère donc
+        // une copie interrompue par une exception.
+        std::vector<std::pair<const Node *, Node **>> stack;
+        if(src){
+            dest->nbElements = src->nbElements;
+            static_cast<typename Balance::NodeData &>(*dest) = *src;
+            static_cast<typename Augment::NodeData &>(*dest) = *src;
+            if(src->right)
+                stack.push_back(std::make_pair(src->right, &dest->right));
+            if(src->left)
+                stack.push_back(std::make_pair(src->left, &dest->left));
+        }
+        while(!stack.empty()){
+            const Node *s = stack.back().first;
+            Node **slot = stack.back().second;
+            stack.pop_back();
+            if(group && s->nbElements <= parallelGrain()){
+                // chaque tâche n'écrit que dans son propre emplacement, ses
+                // allocations sont comptées avec l'opération qui copie
+                group->run([this, s, slot, context = typename OperationScope::Context()]() {
+                    OperationScope scope(context);
+                    Node *d = *slot = newNode(s->key);
+                    copyTree(s, d);
+                });
+                continue;
+            }
+            Node *d = *slot = newNode(s->key);
+            d->nbElements = s->nbElements;
+            static_cast<typename Balance::NodeData &>(*d) = *s;
+            static_cast<typename Augment::NodeData &>(*d) = *s;
+            if(s->right)
+                stack.push_back(std::make_pair(s->right, &d->right));
+            if(s->left)
+                stack.push_back(std::make_pair(s->left, &d->left));
+        }
+    }
+
+     /**
+     * @brief Fonction détruisant sous-arbre donné.
+     *
+     * @param r: Racine du sous-arbre à détruire.
+     *          Peut éventuellement être nul (nullptr).
+     *
+     * @remark Complexité : O(N), sans récursion ni mémoire supplémentaire :
+     *         les rotations à droite amènent chaque noeud à une position sans
+     *         enfant gauche d'où il est détruit.
+     */
+    void deleteSubTree(Node *r) noexcept
+    {
+        while(r)
+        {
+            if(r->left)
+            {
+                Node *l = r->left;
+                r->left = l->right;
+                l->right = r;
+                r = l;
+            }
+            else
+            {
+                Node *next = r->right;
+                deleteNode(r);
+                r = next;
+            }
+        }
+    }
+
+public:
+    //
+    // @brief Insertion d'une clef dans l'arbre
+    //
+    // @param key: la clef à insérer
+    //
+    // @remark Complexité O(log(N)) avec N le nombre de noeuds dans l'arbre
+    //
+    void insert(const_reference key)
+    {
+        OperationScope scope(*this, Operation::Insert);
+        emplaceKey(key, key);
+    }
+
+    /**
+     * @brief Insertion d'une clef déplacée dans l'arbre, seulement si elle
+     *        est absente
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    void insert(value_type &&key)
+    {
+        OperationScope scope(*this, Operation::Insert);
+        emplaceKey(key, std::move(key));
+    }
+
+    /**
+     * @brief Insertion d'une clef construite à partir de args
+     *
+     * Si args est une seule clef comparable à celles de l'arbre (un T, ou
+     * toute clef si Compare est transparent), la descente se fait avec
+     * elle et le noeud n'est alloué et construit qu'une fois sa place
+     * trouvée, si la clef est absente. Sinon la clef doit être construite
+     * pour être comparée : elle l'est directement dans un nouveau noeud,
+     * détruit si elle est déjà présente.
+     *
+     * @return true si la clef a été insérée
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+        OperationScope scope(*this, Operation::Insert);
+        return emplaceArgs(typename SingleKey<Compare, T, Args...>::type(),
+                           std::forward<Args>(args)...);
+    }
+
+private:
+    template <typename K>
+    bool emplaceArgs(std::true_type, K &&key)
+    {
+        return emplaceKey(key, std::forward<K>(key));
+    }
+
+    template <typename... Args>
+    bool emplaceArgs(std::false_type, Args &&... args)
+    {
+        Node *n = newNode(std::in_place, std::forward<Args>(args)...);
+        auto make = [n]() noexcept { return n; };
+        bool inserted;
+        try{
+            inserted = link(n->key, make);
+        }catch(...){
+            deleteNode(n);
+            throw;
+        }
+        if(!inserted){
+            deleteNode(n);
+        }
+        return inserted;
+    }
+
+    /**
+     * @brief Insertion d'une clef équivalente à key, construite à partir de
+     *        args dans un noeud alloué seulement si key est absente
+     *
+     * @return true si la clef a été insérée
+     */
+    template <typename K, typename... Args>
+    bool emplaceKey(const K &key, Args &&... args)
+    {
+        auto make = [&]() { return newNode(std::in_place, std::forward<Args>(args)...); };
+        return link(key, make);
+    }
+
+    /**
+     * @brief Place à la feuille où key doit être insérée le noeud renvoyé
+     *        par make(), puis rééquilibre
+     *
+     * @return false, sans appeler make, si key est déjà présente
+     */
+    template <typename K, typename Make>
+    bool link(const K &key, Make &make)
+    {
+        if(insert(_root, key, make)){
+            Balance::template fixRoot<BinarySearchTree>(_root);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Insertion d'une clef dans un sous-arbre.
+     *
+     * @param r: Racine du sous-arbre dans lequel la clef est insérée
+     * @param key: Clef à insérer
+     * @param make: Appelée par make() pour obtenir le noeud de la clef, une
+     *              fois sa place trouvée. Si elle lève une exception, aucun
+     *              noeud n'a été modifié.
+     *
+     * @return true si la clef est insérée, false si déjà présente
+     *
+     * @remark Complexité : O(log(N))
+     */
+    template <typename K, typename Make>
+    bool insert(Node *&r, const K &key, Make &make)
+    {
+        //Si l'arbre est vide
+        if (r == nullptr)
+        {
+            //Insertion de la nouvelle feuille
+            r = make();
+            return true;
+        }
+        countVisit();
+        bool inserted;
+        int c = compare(key, r->key);
+        if (c < 0)
+        {
+            inserted = insert(r->left, key, make);
+        }
+        else if (c > 0)
+        {
+            inserted = insert(r->right, key, make);
+        }
+        else
+        {
+            return false; // clef déjà présente
+        }
+        // les ancêtres ne sont mis à jour que si la clef a été ajoutée
+        if (inserted)
+        {
+            r->nbElements++;
+            augment(r);
+            Balance::template onInsert<BinarySearchTree>(r);
+        }
+        return inserted;
+    }
+
+public:
+     /**
+     * @brief Recherche d'une clef
+     *
+     * @param key: La clef à rechercher
+     *
+     * @return true si clef trouvée, false dans le cas contraire
+     */
+    bool contains(const_reference key) const noexcept(nothrowCompare<T, T>())
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        return contains(_root, key);
+    }
+
+    // clef d'un autre type, si Compare est transparent
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K &key) const noexcept(nothrowCompare<K, T>())
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        return contains(_root, key);
+    }
+
+private:
+    /**
+     * @brief Recherche d'une clef
+     *
+     * @param key: La clef à rechercher
+     * @param r: La racine du sous-arbre
+     *
+     * @return true sur la clef est trouvée, false sinon
+     *
+     * @remark Complexité O(log(N))
+     */
+    template <typename K>
+    static bool contains(Node *r, const K &key) noexcept(nothrowCompare<K, T>()) {
+        // Si la racine pointe sur null, soit l'arbre est vide, soit on a pas trouvé 
+        // la valeur
+        if (r == nullptr){
+            return false;
+        }
+        countVisit();
+        int c = compare(key, r->key);
+        // Si la valeur est plus petite que la clef de la racine, on va verifier 
+        // dans le sous-arbre gauche
+        if (c < 0){
+            return contains(r->left, key);
+        }else if (c > 0){ // Sinon dans le sous-arbre droit
+            return contains(r->right, key);
+        }else{
+            return true;
+        }
+    }
+    
+    /**
+     * @brief Recherche le noeud minimum du BST
+     * 
+     * @param r: Noeud à partir duquel va s'effectuer la recherche
+     * 
+     * @exception std::logic_error si l'arbre est vide
+     * 
+     * @return Noeud minimum
+     * 
+     * @remark Complexité O(log(N))
+     */
+    static Node *minNode(Node *r){
+        if(r == nullptr){
+            throw std::logic_error("L'arbre est vide, il n'y a donc pas de minimum");
+
+        }
+        else{
+            if(r->left == nullptr){
+                return r;
+            }
+            else{
+                return minNode(r->left);
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Recherche de la clef minimale
+     *
+     * @return Référence constante vers le noeud minimal
+     */
+    const_reference min() const{
+        return this->minNode(_root)->key;
+    }
+
+    /**
+     * @brief Supprime le plus petit élément de l'arbre
+     *
+     * @exception std::logic_error si l'arbre est vide
+     *
+     * @remark : Complexité : O(log(n))
+     */
+    void deleteMin()
+    {
+        OperationScope scope(*this, Operation::Erase);
+        if (_root == nullptr)
+        {
+            throw std::logic_error("Arbre vide il n'est pas possible de delete le min");
+        }
+        bool fix = false;
+        deleteNode(detachMin(_root, fix));
+        Balance::template fixRoot<BinarySearchTree>(_root);
+    }
+
+    /**
+     * @brief Supprime l'élément de la clef de l'arbre
+     * 
+     * @param key: Clef de l'élément à supprimer
+     * 
+     * Ne pas modifier mais écrire la fonction
+     * récursive privée detach(Node*&, const K &, bool &)
+     */
+    bool deleteElement(const_reference key) noexcept(nothrowCompare<T, T>())
+    {
+        OperationScope scope(*this, Operation::Erase);
+        if(Node *n = detach(key)){
+            deleteNode(n);
+            return true;
+        }
+        return false;
+    }
+
+    // clef d'un autre type, si Compare est transparent
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool deleteElement(const K &key) noexcept(nothrowCompare<K, T>())
+    {
+        OperationScope scope(*this, Operation::Erase);
+        if(Node *n = detach(key)){
+            deleteNode(n);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     *  @brief Noeud retiré d'un arbre par extract, avec sa clef.
+     *
+     *  insert(node_type &&) le replace dans un arbre de même type sans
+     *  allocation ni copie de la clef. Sinon il est détruit avec la poignée.
+     */
+    class node_type
+    {
+        friend class BinarySearchTree;
+
+        Node *node = nullptr;
+        std::optional<NodeAllocator> alloc; // allocateur du noeud, s'il y en a un
+
+        node_type(Node *node, const NodeAllocator &alloc) : node(node), alloc(alloc)
+        {
+        }
+
+        // détruit et désalloue le noeud détenu
+        void reset() noexcept
+        {
+            if(node){
+                Tracer::onDestroy(node->key);
+                NodeTraits::destroy(*alloc, node);
+                NodeTraits::deallocate(*alloc, node, 1);
+                node = nullptr;
+            }
+            alloc.reset();
+        }
+
+    public:
+        node_type() noexcept = default;
+
+        node_type(node_type &&other) noexcept
+                : node(other.node), alloc(std::move(other.alloc))
+        {
+            other.node = nullptr;
+            other.alloc.reset();
+        }
+
+        node_type &operator=(node_type &&other) noexcept
+        {
+            if(this != &other){
+                reset();
+                node = other.node;
+                alloc = std::move(other.alloc);
+                other.node = nullptr;
+                other.alloc.reset();
+            }
+            return *this;
+        }
+
+        ~node_type()
+        {
+            reset();
+        }
+
+        bool empty() const noexcept
+        {
+            return node == nullptr;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return node != nullptr;
+        }
+
+        // clef du noeud, la poignée ne doit pas être vide
+        const_reference value() const noexcept
+        {
+            return node->key;
+        }
+    };
+
+    /**
+     * @brief Retire de l'arbre le noeud de la clef, sans le détruire
+     *
+     * @return Le noeud, une poignée vide si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    node_type extract(const_reference key)
+    {
+        OperationScope scope(*this, Operation::Erase);
+        Node *n = detach(key);
+        return n ? node_type(n, _alloc) : node_type();
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    node_type extract(const K &key)
+    {
+        OperationScope scope(*this, Operation::Erase);
+        Node *n = detach(key);
+        return n ? node_type(n, _alloc) : node_type();
+    }
+
+    /**
+     * @brief Insertion du noeud d'une poignée, sans allocation ni copie. Si
+     *        l'allocateur de la poignée diffère de celui de l'arbre, la clef
+     *        est copiée dans un nouveau noeud.
+     *
+     * @return true si la clef a été insérée et la poignée vidée, false si
+     *         la poignée est vide ou la clef déjà présente, la poignée
+     *         gardant alors son noeud
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    bool insert(node_type &&handle)
+    {
+        if(handle.empty()){
+            return false;
+        }
+        OperationScope scope(*this, Operation::Insert);
+        if(!(*handle.alloc == _alloc)){
+            if(!emplaceKey(handle.value(), handle.value())){
+                return false;
+            }
+            handle.reset();
+            return true;
+        }
+        Node *n = handle.node;
+        // le noeud redevient une feuille neuve
+        auto make = [n]() noexcept {
+            n->left = nullptr;
+            n->right = nullptr;
+            n->nbElements = 1;
+            static_cast<typename Balance::NodeData &>(*n) = typename Balance::NodeData();
+            augment(n);
+            return n;
+        };
+        if(!link(n->key, make)){
+            return false;
+        }
+        handle.node = nullptr;
+        handle.alloc.reset();
+        return true;
+    }
+
+private:
+    // retire le noeud de key et rééquilibre, sans le détruire
+    template <typename K>
+    Node *detach(const K &key) noexcept(nothrowCompare<K, T>())
+    {
+        bool fix = false;
+        Node *n = detach(_root, key, fix);
+        if(n){
+            Balance::template fixRoot<BinarySearchTree>(_root);
+        }
+        return n;
+    }
+
+    /**
+     * @brief Détache le noeud minimal d'un sous-arbre
+     * 
+     * @param r: Racine du sous-arbre, ne peut être nullptr
+     * @param fix: Mis à true si les ancêtres de r doivent être rééquilibrés
+     * 
+     * @return Le noeud minimal, qui n'est plus relié à l'arbre
+     * 
+     * @remark Complexité O(log(N))
+     */
+    static Node *detachMin(Node *&r, bool &fix) noexcept {
+        countVisit();
+        if(r->left != nullptr){
+            Node *min = detachMin(r->left, fix);
+            r->nbElements--;
+            augment(r);
+            if(fix)
+                fix = Balance::template onErase<BinarySearchTree>(r, true);
+            return min;
+        }
+        Node *min = r;
+        r = r->right;
+        fix = Balance::template onUnlink<BinarySearchTree>(min, r);
+        return min;
+    }
+
+    /**
+     * @brief Retire l'élément clef du sous-arbre, sans le détruire
+     * 
+     * @param r: Racine du sous-arbre
+     * @param key: Elément à retirer
+     * @param fix: Mis à true si les ancêtres de r doivent être rééquilibrés
+     * 
+     * @return Le noeud retiré, nullptr si la clef est absente
+     * 
+     * @remark Complexité O(log(N))
+     */
+    template <typename K>
+    static Node *detach(Node *&r, const K &key, bool &fix) noexcept(nothrowCompare<K, T>()) {
+        if (r == nullptr){
+            return nullptr;
+        }
+        countVisit();
+        int c = compare(key, r->key);
+        Node *found;
+        if (c < 0){
+            if(!(found = detach(r->left, key, fix)))
+                return nullptr;
+            r->nbElements--;
+            augment(r);
+            if(fix)
+                fix = Balance::template onErase<BinarySearchTree>(r, true);
+        }
+        else if (c > 0){
+            if(!(found = detach(r->right, key, fix)))
+                return nullptr;
+            r->nbElements--;
+            augment(r);
+            if(fix)
+                fix = Balance::template onErase<BinarySearchTree>(r, false);
+        }
+        else{
+            Node *tmp = r;
+            if (r->left == nullptr){
+                r = r->right;
+                fix = Balance::template onUnlink<BinarySearchTree>(tmp, r);
+            }
+            else if (r->right == nullptr){
+                r = r->left;
+                fix = Balance::template onUnlink<BinarySearchTree>(tmp, r);
+            }
+            else{
+                // le successeur prend la place du noeud supprimé
+                Node *min = detachMin(tmp->right, fix);
+                min->left = tmp->left;
+                min->right = tmp->right;
+                min->nbElements = tmp->nbElements - 1;
+                static_cast<typename Balance::NodeData &>(*min) = *tmp;
+                augment(min);
+                r = min;
+                if(fix)
+                    fix = Balance::template onErase<BinarySearchTree>(r, false);
+            }
+            found = tmp;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Nombre de noeuds d'un sous-arbre
+     * 
+     * @param r: Racine du sous-arbre, peut être nullptr
+     * 
+     * @remark Complexité O(1)
+     */
+    static size_t size(const Node *r) noexcept {
+        return r ? r->nbElements : 0;
+    }
+
+    // vérifie le sous-arbre r, dont les clefs doivent être comprises
+    // strictement entre *lo et *hi quand ils ne sont pas nuls
+    bool checkInvariants(const Node *r, const value_type *lo, const value_type *hi) const {
+        if(r == nullptr)
+            return true;
+        if((lo && !less(*lo, r->key)) || (hi && !less(r->key, *hi)))
+            return false;
+        return checkInvariants(r->left, lo, &r->key) &&
+               checkInvariants(r->right, &r->key, hi) &&
+               r->nbElements == size(r->left) + size(r->right) + 1 &&
+               Balance::template valid<BinarySearchTree>(r);
+    }
+
+    /**
+     * @brief Rotation à gauche autour de r, maintient nbElements
+     * 
+     * @param r: Racine du sous-arbre, son enfant droit en devient la racine
+     * 
+     * @remark Complexité O(1)
+     */
+    static void rotateLeft(Node *&r) noexcept {
+        Node *x = r->right;
+        r->right = x->left;
+        x->left = r;
+        x->nbElements = r->nbElements;
+        r->nbElements = size(r->left) + size(r->right) + 1;
+        augment(r);
+        augment(x);
+        r = x;
+    }
+
+    /**
+     * @brief Rotation à droite autour de r, maintient nbElements
+     * 
+     * @param r: Racine du sous-arbre, son enfant gauche en devient la racine
+     * 
+     * @remark Complexité O(1)
+     */
+    static void rotateRight(Node *&r) noexcept {
+        Node *x = r->left;
+        r->left = x->right;
+        x->right = r;
+        x->nbElements = r->nbElements;
+        r->nbElements = size(r->left) + size(r->right) + 1;
+        augment(r);
+        augment(x);
+        r = x;
+    }
+
+    /**
+     * @brief Pose m au-dessus de l et r et met à jour son nbElements
+     *
+     * @return m
+     *
+     * @remark Complexité O(1)
+     */
+    static Node *attach(Node *l, Node *m, Node *r) noexcept {
+        m->left = l;
+        m->right = r;
+        m->nbElements = size(l) + size(r) + 1;
+        augment(m);
+        return m;
+    }
+
+    /**
+     * @brief Met à jour les données d'augmentation de n à partir de ses
+     *        enfants, à appeler après chaque mise à jour de nbElements
+     *
+     * @remark Complexité O(1)
+     */
+    static void augment(Node *n) noexcept {
+        Augment::template update<BinarySearchTree>(n);
+    }
+
+    /**
+     * @brief Met à jour les données d'augmentation de tout un sous-arbre,
+     *        des feuilles vers la racine, après arborize ou build qui ne
+     *        fixent que nbElements
+     *
+     * @remark Complexité O(N), O(1) sans augmentation. La récursion suit
+     *         la hauteur de l'arbre, logarithmique après arborize.
+     */
+    static void augmentSubTree(Node *r) noexcept {
+        if(!Augment::enabled || r == nullptr){
+            return;
+        }
+        augmentSubTree(r->left);
+        augmentSubTree(r->right);
+        augment(r);
+    }
+
+    // rang d'un sous-arbre au sens de la politique d'équilibrage
+    static int joinRank(const Node *r) noexcept {
+        return Balance::template rank<BinarySearchTree>(r);
+    }
+
+    static int childRank(const Node *parent, int rank, const Node *child) noexcept {
+        return Balance::template childRank<BinarySearchTree>(parent, rank, child);
+    }
+
+    /**
+     * @brief Réunit l, m et r, les clefs de l étant inférieures à celle de m
+     *        et celles de r supérieures
+     *
+     * @param rl, rr: Rangs de l et r
+     * @param rank: Reçoit le rang du résultat
+     *
+     * @return La racine du résultat
+     *
+     * @remark Complexité O(log(N)), O(|rl - rr| + 1) pour AVL et rouge-noir
+     */
+    static Node *join(Node *l, int rl, Node *m, Node *r, int rr, int &rank) noexcept {
+        return Balance::template join<BinarySearchTree>(l, rl, m, r, rr, rank);
+    }
+
+    /**
+     * @brief Réunit l et r, les clefs de l étant inférieures à celles de r :
+     *        le minimum de r est séparé du reste par split et sert de noeud
+     *        central. Contrairement à detachMin, aucune reconstruction
+     *        scapegoat n'est déclenchée.
+     *
+     * @remark Complexité O(log(N))
+     */
+    static Node *join(Node *l, int rl, Node *r, int rr, int &rank) noexcept {
+        if(r == nullptr){
+            rank = rl;
+            return l;
+        }
+        if(l == nullptr){
+            rank = rr;
+            return r;
+        }
+        auto first = [](const Node *n) { return n->left ? -1 : 0; };
+        Node *none, *rest;
+        int rn, rrest;
+        Node *m = split(r, rr, first, none, rn, rest, rrest);
+        return join(l, rl, m, rest, rrest, rank);
+    }
+
+    /**
+     * @brief Sépare le sous-arbre t autour de la position désignée par where
+     *
+     * Chaque noeud du chemin de t à cette position est détaché puis
+     * rattaché, par join, aux morceaux gauche ou droit déjà construits :
+     * les coûts des join successifs se compensent et le total reste en
+     * O(log(N)) pour AVL et rouge-noir.
+     *
+     * @param t: Racine du sous-arbre, de rang rank
+     * @param where: where(n) est négatif si la position est à gauche de n,
+     *               positif si elle est à droite et nul si c'est n
+     * @param l, rl: Reçoivent les noeuds à gauche de la position et leur rang
+     * @param r, rr: Reçoivent les noeuds à droite de la position et leur rang
+     *
+     * @return Le noeud à la position, détaché, ou nullptr s'il n'y en a pas
+     *
+     * @remark Complexité O(h) avec h la hauteur de t
+     */
+    template <typename Where>
+    static Node *split(Node *t, int rank, Where &where,
+                       Node *&l, int &rl, Node *&r, int &rr) noexcept {
+        if(t == nullptr){
+            l = r = nullptr;
+            rl = rr = joinRank(t);
+            return nullptr;
+        }
+        Node *tl = t->left;
+        Node *tr = t->right;
+        int kl = childRank(t, rank, tl);
+        int kr = childRank(t, rank, tr);
+        int side = where(t);
+        if(side < 0){
+            Node *found = split(tl, kl, where, l, rl, r, rr);
+            r = join(r, rr, t, tr, kr, rr);
+            return found;
+        }
+        if(side > 0){
+            Node *found = split(tr, kr, where, l, rl, r, rr);
+            l = join(tl, kl, t, l, rl, rl);
+            return found;
+        }
+        l = tl;
+        rl = kl;
+        r = tr;
+        rr = kr;
+        return t;
+    }
+
+    /**
+     * @brief Sépare l'arbre en deux : l reçoit les clefs à gauche de la
+     *        position désignée par where, r les autres. L'arbre est vidé.
+     *
+     * @remark Complexité O(log(N)) pour AVL et rouge-noir
+     */
+    template <typename Where>
+    void splitInto(Where where, Node *&l, Node *&r) noexcept {
+        int rl, rr;
+        splitBefore(_root, joinRank(_root), where, l, rl, r, rr);
+        _root = nullptr;
+        Balance::template fixRoot<BinarySearchTree>(l);
+        Balance::template fixRoot<BinarySearchTree>(r);
+    }
+
+    /**
+     * @brief Comme split, mais le noeud à la position désignée par where
+     *        est rattaché à r, dont il devient le minimum
+     */
+    template <typename Where>
+    static void splitBefore(Node *t, int rank, Where where,
+                            Node *&l, int &rl, Node *&r, int &rr) noexcept {
+        Node *found = split(t, rank, where, l, rl, r, rr);
+        if(found){
+            r = join(nullptr, joinRank(nullptr), found, r, rr, rr);
+        }
+    }
+
+    // position du rang n, pour split. Le rang est rendu relatif au
+    // sous-arbre dans lequel split descend.
+    static auto rankPosition(size_t n) noexcept {
+        return [n](const Node *r) mutable {
+            size_t nbElementsGauche = size(r->left);
+            if(n < nbElementsGauche){
+                return -1;
+            }
+            if(n == nbElementsGauche){
+                return 0;
+            }
+            n -= nbElementsGauche + 1;
+            return 1;
+        };
+    }
+
+    /**
+     * @brief Retire les noeuds situés entre les positions from et to : deux
+     *        split détachent le sous-arbre intermédiaire et un join
+     *        rattache les deux bords
+     *
+     * @param from: Première position retirée
+     * @param to: Première position gardée après from, where sur le reste de
+     *            l'arbre une fois les noeuds avant from détachés
+     *
+     * @return Le nombre de noeuds retirés
+     *
+     * @remark Complexité O(log(N)) pour AVL et rouge-noir, plus la
+     *         libération des k noeuds retirés
+     */
+    template <typename From, typename To>
+    size_t eraseBetween(From from, To to, bool background) noexcept {
+        Node *l, *rest, *mid, *r;
+        int rl, rrest, rmid, rr;
+        splitBefore(_root, joinRank(_root), from, l, rl, rest, rrest);
+        splitBefore(rest, rrest, to, mid, rmid, r, rr);
+        int rank;
+        _root = join(l, rl, r, rr, rank);
+        Balance::template fixRoot<BinarySearchTree>(_root);
+        size_t n = size(mid);
+        releaseSubTree(mid, background);
+        return n;
+    }
+
+    /**
+     * @brief Libère un sous-arbre détaché de l'arbre
+     *
+     * @param background: Si vrai, un grand sous-arbre est libéré par une
+     *                    tâche de la réserve de threads, pourvu que
+     *                    l'allocateur soit sans état et le traçage désactivé.
+     *                    Sinon, ou si la tâche ne peut être soumise, il est
+     *                    libéré immédiatement.
+     */
+    void releaseSubTree(Node *r, bool background) noexcept {
+        if(!(background && useParallel(size(r)))){
+            deleteSubTree(r);
+            return;
+        }
+        std::shared_ptr<BinarySearchTree> garbage;
+        try{
+            garbage = std::make_shared<BinarySearchTree>(sharingAllocator());
+        }catch(...){
+            deleteSubTree(r);
+            return;
+        }
+        garbage->_root = r;
+        try{
+            WorkStealingPool::instance().submit([garbage]() { garbage->clear(); });
+        }catch(...){
+            // garbage, seul propriétaire, libère les noeuds ici
+        }
+    }
+
+    /**
+     * @brief Réunit les sous-arbres a et b de même allocateur en réutilisant
+     *        leurs noeuds, les doublons de b étant détruits : a est découpé
+     *        par la clef de la racine de b, les morceaux sont réunis
+     *        récursivement aux sous-arbres de b puis rattachés par join.
+     *
+     * @param ra, rb: Rangs de a et b
+     * @param rank: Reçoit le rang du résultat
+     *
+     * @remark Complexité O(m log(n / m + 1)) pour AVL et rouge-noir, avec m
+     *         la taille de b et n celle de a. Reste noexcept même si
+     *         Compare peut lever, les comparaisons se faisant entre deux
+     *         restructurations.
+     */
+    Node *unite(Node *a, int ra, Node *b, int rb, int &rank) noexcept {
+        if(b == nullptr){
+            rank = ra;
+            return a;
+        }
+        if(a == nullptr){
+            rank = rb;
+            return b;
+        }
+        Node *bl = b->left;
+        Node *br = b->right;
+        int kl = childRank(b, rb, bl);
+        int kr = childRank(b, rb, br);
+        auto where = [b](const Node *n) { return compare(b->key, n->key); };
+        Node *al, *ar;
+        int ral, rar;
+        Node *dup = split(a, ra, where, al, ral, ar, rar);
+        if(dup){
+            deleteNode(dup);
+        }
+        Node *l = unite(al, ral, bl, kl, ral);
+        Node *r = unite(ar, rar, br, kr, rar);
+        return join(l, ral, b, r, rar, rank);
+    }
+
+public:
+    /**
+     * @brief Taille de l'arbre
+     * 
+     * @return Le nombre d'éléments de l'arbre
+     * 
+     * @remark Complexité O(1)
+     */
+    size_t size() const noexcept {
+        return _root ? _root->nbElements : 0;
+    }
+
+    /**
+     * @brief Cherche la clef en position n
+     * 
+     * @return référence à la clef en position n par ordre croissant des
+     *         éléments
+     * 
+     * @exception std::logic_error (std::out_of_range) si n >= size(), les
+     *            positions allant de 0 à size()-1
+     * 
+     * @remark Complexité O(log(N))
+     */
+    const_reference nth_element(size_t n) const {
+        OperationScope scope(*this, Operation::Rank);
+        if(_root == nullptr || n >= _root->nbElements){
+            throw std::out_of_range("L'arbre ne contient pas autant d'elements");
+        }
+        return nth_element(_root, n);
+    }
+
+private:
+    /**
+     * @brief Clef en position n dans un sous-arbre
+     * 
+     * @param r: Racine du sous-arbre, ne peut être nullptr
+     * @param n: Position n
+     * 
+     * @ return référence à la clef en position n, par ordre croissant des éléments.
+     * 
+     * @remark Complexité O(log(N))
      */
-    struct Node
-    {
-        const value_type key; // clef non modifiable
-        Node *right;          // sous arbre avec des clefs plus grandes
-        Node *left;           // sous arbre avec des clefs plus petites
-        size_t nbElements;    // nombre de noeuds dans le sous-arbre dont
-                              // ce noeud est la racine
+    static const_reference nth_element(Node *r, size_t n) noexcept {
+        assert(r != nullptr);
+        countVisit();
+        size_t nbElementsGauche = 0;
 
-        Node(const_reference key) // seul constructeur disponible, key est obligatoire
-                : key(key), right(nullptr), left(nullptr), nbElements(1)
-        {
-            cout << "(C" << key << ") ";
-        }
-        ~Node() // destructeur
-        {
-            cout << "(D" << key << ") ";
+        if (r->left){
+            nbElementsGauche = r->left->nbElements;
         }
-        Node() = delete;             // pas de construction par défaut
-        Node(const Node &) = delete; // pas de construction par copie
-        Node(Node &&) = delete;      // pas de construction par déplacement
-    };
 
-    /**
-     * Racine de l'arbre. Nullptr si l'arbre est vide.
-     */
-    Node *_root;
+        //n-ième élément dans le sous-arbre gauche
+        if (n > nbElementsGauche) {
+            return nth_element(r->right, n - nbElementsGauche - 1);
+        }
+            //n-ième élément dans le sous-arbre droit
+        else if (n < nbElementsGauche) {
+            return nth_element(r->left, n);
+        }
+            //n-ième élément est la racine
+        else {
+            return r->key;
+        }
+    }
 
 public:
+
     /**
-     *  @brief Constructeur par défaut. Construit un arbre vide
+     * @brief Position d'une clef dans l'ordre croissant des éléments de l'arbre
+     * 
+     * @param key: La clef dont on cherche le rang
+     * 
+     * @return La position entre  0 et size()-1, size_t(-1) si la clef est absente
      */
-    BinarySearchTree() : _root(nullptr)
-    {
+    size_t rank(const_reference key) const noexcept(nothrowCompare<T, T>()) {
+        OperationScope scope(*this, Operation::Rank);
+        return rank(_root, key);
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_t rank(const K &key) const noexcept(nothrowCompare<K, T>()) {
+        OperationScope scope(*this, Operation::Rank);
+        return rank(_root, key);
     }
 
+private:
     /**
-     *  @brief Constucteur de copie
-     *
-     *  @param other: le BinarySearchTree à copier
-     *
-     *  @remark Complexité : O(N).
+     * @brief Position d'une clef dans l'ordre croissant des éléments du sous-arbre
+     * 
+     * @param key: La clef dont on cherche le rang
+     * @param r: Racine du sous-arbre
+     * 
+     * @return La position entre  0 et size()-1, size_t(-1) si la clef est absente
+     * 
+     * @remark Complexité O(log(N))
      */
-    BinarySearchTree(const BinarySearchTree &other)
+    template <typename K>
+    static size_t rank(Node *r, const K &key) noexcept(nothrowCompare<K, T>())
     {
-        if (other._root)
-        {
-            //On essaye d'effectuer la copie
-            try{
-                _root = new Node(other._root->key);
-                copyTree(other._root, _root);
-            }
-            //Si la copie n'a pas reussi, 
-            //on supprime ce qui a été créé pendant l'essai
-            catch (...)
-            {
-                deleteSubTree(_root);
-                _root = nullptr;
-                throw;
+        size_t nbElementsAvant = 0; // clefs inférieures hors du sous-arbre r
+        while (r != nullptr) {
+            countVisit();
+            int c = compare(key, r->key);
+            if (c < 0){
+                r = r->left;
+            } else if (c > 0){
+                nbElementsAvant += size(r->left) + 1;
+                r = r->right;
+            }else{
+                return nbElementsAvant + size(r->left);
             }
         }
+        return (size_t)-1;
     }
 
+public:
     /**
-     *  @brief Opérateur d'affectation par copie
+     * @brief Itérateur sur la plus petite clef
      *
-     *  @param other: Le BinarySearchTree (BST) à copier
-     * 
-     *  @remark Complexié O(N) avec N le nombre de sous arbres 
+     * @remark Complexité O(log(N))
      */
-    BinarySearchTree &operator=(const BinarySearchTree &other)
+    const_iterator begin() const
     {
-        Node* root = nullptr;
-        if(other._root){
-            root = new Node(other._root->key);
-            try{
-                copyTree(other._root,root);
-            }catch(...){
-                deleteSubTree(root);
-                throw;
-            }
+        const_iterator it(_root);
+        if(_root){
+            it.path.push_back(_root);
+            it.descendLeft();
         }
-        _root = root;
-        return *this;
+        return it;
     }
 
     /**
-     *  @brief Echange le contenu avec un autre BST
-     *
-     *  @param other: le BST avec lequel on echange le contenu
+     * @brief Itérateur suivant la plus grande clef
      *
-     *  @remark Complexité O(1)
+     * @remark Complexité O(1)
      */
-    void swap(BinarySearchTree &other) noexcept
+    const_iterator end() const noexcept
     {
-        if(_root != other._root){
-            Node *temp = _root;
-            _root = other._root;
-            other._root = temp;
-        }
+        return const_iterator(_root);
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
     }
 
     /**
-     *  @brief Constructeur de copie par déplacement
+     * @brief Recherche d'une clef
      *
-     *  @param other: le BST dont on vole le contenu
+     * @param key: la clef à rechercher
      *
-     *  @remark Complexité O(1)
+     * @return Itérateur sur la clef, end() si elle est absente
+     *
+     * @remark Complexité O(log(N))
      */
-    BinarySearchTree(BinarySearchTree &&other) noexcept
+    const_iterator find(const_reference key) const
     {
-        if(other._root){
-            _root = other._root;
-            other._root = nullptr;
-        }else{
-            _root = nullptr;
-        }
+        return findKey(key);
+    }
+
+    // clef d'un autre type, si Compare est transparent
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K &key) const
+    {
+        return findKey(key);
     }
 
     /**
-     *  @brief Opérateur d'affectation par déplacement
+     * @brief Première clef qui n'est pas inférieure à key
      *
-     *  @param other: le BST dont on vole le contenu
+     * @return Itérateur sur la plus petite clef >= key, end() s'il n'y en a pas
      *
-     *  @remark Complexité O(1)
+     * @remark Complexité O(log(N))
      */
-    BinarySearchTree &operator=(BinarySearchTree &&other) noexcept
+    const_iterator lower_bound(const_reference key) const
     {
-        if(_root != other._root){
-            _root = other._root;
-            other._root = nullptr;
-        }else if(other._root){
-            _root = nullptr;
-        }
-        return *this;
+        return lowerBound(key);
     }
-    /**
-     *  @brief Destructeur
-     * 
-     *  @remark Complexité O(N) avec N le nombre de noeuds dans l'arbre
-     */
-    ~BinarySearchTree()
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &key) const
     {
-        deleteSubTree(_root);
+        return lowerBound(key);
     }
 
-private:
     /**
-     * @brief Copie un BTS dans un autre.
+     * @brief Première clef supérieure à key
      *
-     * @param src: Racine du BTS a copier.
-     * @param src: Racine du BTS copié.
+     * @return Itérateur sur la plus petite clef > key, end() s'il n'y en a pas
      *
-     * @remark Complexité : O(N) avec N le nombre de noeuds dans src
+     * @remark Complexité O(log(N))
      */
-    void copyTree(Node* src, Node* dest){
-        if(src){
-            dest->nbElements = src->nbElements;
-            if(src->left){
-                Node* leftNode = new Node(src->left->key);
-                dest->left = leftNode;
-                copyTree(src->left, dest->left);
-            }
-            if(src->right){
-                Node* rightNode = new Node(src->right->key);
-                dest->right = rightNode;
-                copyTree(src->right, dest->right);
-            }
-        }
+    const_iterator upper_bound(const_reference key) const
+    {
+        return upperBound(key);
     }
 
-     /**
-     * @brief Fonction détruisant sous-arbre donné.
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &key) const
+    {
+        return upperBound(key);
+    }
+
+    /**
+     * @brief Intervalle des clefs égales à key
      *
-     * @param r: Racine du sous-arbre à détruire.
-     *          Peut éventuellement être nul (nullptr).
+     * @return La paire (lower_bound(key), upper_bound(key)), qui contient au
+     *         plus un élément
      *
-     * @remark Complexité : O(log(N))
+     * @remark Complexité O(log(N))
      */
-    static void deleteSubTree(Node *r) noexcept
+    std::pair<const_iterator, const_iterator> equal_range(const_reference key) const
     {
-        if(r)
-        {
-            deleteSubTree(r->left);
-            deleteSubTree(r->right);
-            delete r;
-        }
+        return std::make_pair(lowerBound(key), upperBound(key));
     }
 
-public:
-    //
-    // @brief Insertion d'une clef dans l'arbre
-    //
-    // @param key: la clef à insérer
-    //
-    // @remark Complexité O(log(N)) avec N le nombre de noeuds dans l'arbre
-    //
-    void insert(const_reference key)
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K &key) const
     {
-        insert(_root, key);
+        return std::make_pair(lowerBound(key), upperBound(key));
     }
 
-private:
     /**
-     * @brief Insertion d'une clef dans un sous-arbre.
+     * @brief Nombre de clefs strictement inférieures à key
      *
-     * @param r: Racine du sous-arbre dans lequel la clef est insérée
-     * @param key: Clef à insérer
+     * @param key: La clef de référence, présente ou non dans l'arbre
      *
-     * @return true si la clef est insérée, false si déjà présente
+     * @return Le nombre de clefs < key, égal au rang de key si elle est présente
      *
-     * @remark Complexité : O(log(N))
+     * @remark Complexité O(log(N))
      */
-    static bool insert(Node *&r, const_reference key)
+    size_t count_less(const_reference key) const noexcept(nothrowLess<T, T>())
     {
-        if(contains(r, key)){
-            return false;
-        }
-            //Si l'arbre est vide
-        else if (r == nullptr)
-        {
-            r = new Node(key);
-            return true;
-        }
-        else if (key > r->key)
-        {
-            if (r->right == nullptr)
-            {
-                //Insertion de la nouvelle feuille
-                r->right = new Node(key);
-                r->nbElements++;
-                return true;
+        return countLess(key);
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_t count_less(const K &key) const noexcept(nothrowLess<T, K>())
+    {
+        return countLess(key);
+    }
+
+private:
+    template <typename K>
+    const_iterator findKey(const K &key) const
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        const_iterator it(_root);
+        for(const Node *r = _root; r != nullptr; ){
+            countVisit();
+            it.path.push_back(r);
+            int c = compare(key, r->key);
+            if(c < 0){
+                r = r->left;
+            }else if(c > 0){
+                r = r->right;
+            }else{
+                return it;
             }
-            else{
-                if(insert(r->right, key)){
-                    r->nbElements++;
-                }
-                return true;
+        }
+        return end();
+    }
+
+    template <typename K>
+    const_iterator lowerBound(const K &key) const
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        const_iterator it(_root);
+        size_t found = 0; // longueur du chemin vers la meilleure candidate
+        for(const Node *r = _root; r != nullptr; ){
+            countVisit();
+            it.path.push_back(r);
+            if(less(r->key, key)){
+                r = r->right;
+            }else{
+                found = it.path.size();
+                r = r->left;
             }
         }
-        else if (key < r->key)
-        {
-            if (r->left == nullptr)
-            {
-                //Insertion de la nouvelle feuille
-                r->left = new Node(key);
-                r->nbElements++;
-                return true;
+        it.path.resize(found);
+        return it;
+    }
+
+    template <typename K>
+    const_iterator upperBound(const K &key) const
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        const_iterator it(_root);
+        size_t found = 0;
+        for(const Node *r = _root; r != nullptr; ){
+            countVisit();
+            it.path.push_back(r);
+            if(less(key, r->key)){
+                found = it.path.size();
+                r = r->left;
+            }else{
+                r = r->right;
             }
-            else{
-                if(insert(r->left, key)){
-                    r->nbElements++;
-                }
-                return true;
+        }
+        it.path.resize(found);
+        return it;
+    }
+
+    template <typename K>
+    size_t countLess(const K &key) const noexcept(nothrowLess<T, K>())
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        size_t cnt = 0;
+        for(const Node *r = _root; r != nullptr; ){
+            countVisit();
+            if(less(r->key, key)){
+                cnt += size(r->left) + 1;
+                r = r->right;
+            }else{
+                r = r->left;
             }
         }
+        return cnt;
     }
 
 public:
-     /**
-     * @brief Recherche d'une clef
+
+    /**
+     * @brief Nombre de clefs dans l'intervalle [lo, hi[
      *
-     * @param key: La clef à rechercher
+     * @param lo: Borne inférieure incluse
+     * @param hi: Borne supérieure exclue
      *
-     * @return true si clef trouvée, false dans le cas contraire
+     * @remark Complexité O(log(N))
      */
-    bool contains(const_reference key) const noexcept
+    size_t count_in_range(const_reference lo, const_reference hi) const
+            noexcept(nothrowLess<T, T>())
     {
-        return contains(_root, key);
+        return less(lo, hi) ? count_less(hi) - count_less(lo) : 0;
     }
 
-private:
     /**
-     * @brief Recherche d'une clef
+     * @brief Combinaison des valeurs de toutes les clefs par le monoïde de
+     *        l'augmentation, disponible avec MonoidAugment
      *
-     * @param key: La clef à rechercher
-     * @param r: La racine du sous-arbre
+     * @remark Complexité O(1)
+     */
+    template <typename A = Augment>
+    typename A::value_type aggregate() const
+    {
+        return A::subtree(_root);
+    }
+
+    /**
+     * @brief Combinaison des valeurs des clefs de l'intervalle [lo, hi[, par
+     *        ordre croissant, disponible avec MonoidAugment
      *
-     * @return true sur la clef est trouvée, false sinon
+     * @param lo: Borne inférieure incluse
+     * @param hi: Borne supérieure exclue
+     *
+     * @return Monoid::identity() si l'intervalle est vide
      *
      * @remark Complexité O(log(N))
      */
-    static bool contains(Node *r, const_reference key) noexcept {
-        // Si la racine pointe sur null, soit l'arbre est vide, soit on a pas trouvé 
-        // la valeur
-        if (r == nullptr){
-            return false;
-        }else if (key == r->key){
-            return true;
-        // Si la valeur est plus grande que la clef de la racine, on va verifier 
-        // dans le sous-arbre droit
-        }else if (key > r->key){
-            contains(r->right, key);
-        }else{ // Sinon dans le sous-arbre gauche
-            contains(r->left, key);
-        }
+    template <typename A = Augment>
+    typename A::value_type aggregate(const_reference lo, const_reference hi) const
+    {
+        return aggregateRange<A>(lo, hi);
     }
-    
-    /**
-     * @brief Recherche le noeud minimum du BST
-     * 
-     * @param r: Noeud à partir duquel va s'effectuer la recherche
-     * 
-     * @exception std::logic_error si l'arbre est vide
-     * 
-     * @return Noeud minimum
-     * 
-     * @remark Complexité O(log(N))
+
+    // bornes d'un autre type, si Compare est transparent
+    template <typename K, typename C = Compare, typename = typename C::is_transparent,
+              typename A = Augment>
+    typename A::value_type aggregate(const K &lo, const K &hi) const
+    {
+        return aggregateRange<A>(lo, hi);
+    }
+
+private:
+    /**
+     * @brief Descend jusqu'au premier noeud r de l'intervalle, puis combine
+     *        les sous-arbres entiers rencontrés le long des deux chemins
+     *        de r vers lo et vers hi
      */
-    static Node *minNode(Node *r){
+    template <typename A, typename K>
+    typename A::value_type aggregateRange(const K &lo, const K &hi) const
+    {
+        OperationScope scope(*this, Operation::Lookup);
+        const Node *r = _root;
+        while(r){
+            countVisit();
+            if(less(r->key, lo)){
+                r = r->right;
+            }else if(!less(r->key, hi)){
+                r = r->left;
+            }else{
+                break;
+            }
+        }
         if(r == nullptr){
-            throw std::logic_error("L'arbre est vide, il n'y a donc pas de minimum");
-
+            return A::identity();
         }
-        else{
-            if(r->left == nullptr){
-                return r;
+        // clefs >= lo du sous-arbre gauche, de droite à gauche
+        typename A::value_type left = A::identity();
+        for(const Node *n = r->left; n != nullptr; ){
+            countVisit();
+            if(less(n->key, lo)){
+                n = n->right;
+            }else{
+                left = A::combine(A::combine(A::single(n), A::subtree(n->right)), left);
+                n = n->left;
             }
-            else{
-                minNode(r->left);
+        }
+        // clefs < hi du sous-arbre droit, de gauche à droite
+        typename A::value_type right = A::identity();
+        for(const Node *n = r->right; n != nullptr; ){
+            countVisit();
+            if(less(n->key, hi)){
+                right = A::combine(right, A::combine(A::subtree(n->left), A::single(n)));
+                n = n->right;
+            }else{
+                n = n->left;
             }
         }
+        return A::combine(A::combine(left, A::single(r)), right);
     }
 
-public:
     /**
-     * @brief Recherche de la clef minimale
+     * @brief Applique fn à la clef équivalente à key, puis met à jour
+     *        l'augmentation des noeuds du chemin. fn ne peut changer que des
+     *        membres mutable de la clef, sans effet sur l'ordre.
      *
-     * @return Référence constante vers le noeud minimal
+     * @return false si la clef est absente
+     *
+     * @remark Complexité O(log(N))
      */
-    const_reference min() const{
-        this->minNode(_root)->key;
+    template <typename K, typename Fn>
+    static bool modify(Node *r, const K &key, Fn &fn)
+    {
+        if(r == nullptr){
+            return false;
+        }
+        countVisit();
+        int c = compare(key, r->key);
+        bool found;
+        if(c < 0){
+            found = modify(r->left, key, fn);
+        }else if(c > 0){
+            found = modify(r->right, key, fn);
+        }else{
+            fn(r->key);
+            found = true;
+        }
+        if(found){
+            augment(r);
+        }
+        return found;
     }
 
+public:
+
     /**
-     * @brief Supprime le plus petit élément de l'arbre
+     * @brief Parcours symétrique des clefs de l'intervalle [lo, hi[
      *
-     * @exception std::logic_error si l'arbre est vide
+     * @param lo: Borne inférieure incluse
+     * @param hi: Borne supérieure exclue
+     * @param f: Fonction appelée par f(key) pour chaque clef de l'intervalle,
+     *           par ordre croissant
      *
-     * @remark : Complexité : O(log(n))
+     * @remark Complexité O(log(N) + k) avec k le nombre de clefs visitées
      */
-    void deleteMin()
+    template <typename Fn>
+    void visit_range(const_reference lo, const_reference hi, Fn f) const
     {
-        Node *noeud = _root;
-        if (noeud == nullptr)
-        {
-            throw std::logic_error("Arbre vide il n'est pas possible de delete le min");
-        }
-        if (noeud->left == nullptr)
-        {
-            _root = noeud->right;
-            delete (noeud);
-            return;
-        }
-        while (noeud->left->left != nullptr)
-        {
-            noeud->nbElements--;
-            noeud = noeud->left;
-        }
-        noeud->nbElements--;
-        Node *temp = noeud->left;
-        noeud->left = noeud->left->right;
-        noeud = nullptr;
-        delete noeud;
-        delete temp;
-    };
+        visitRange(_root, lo, hi, f);
+    }
 
     /**
-     * @brief Supprime l'élément de la clef de l'arbre
-     * 
-     * @param key: Clef de l'élément à supprimer
-     * 
-     * Ne pas modifier mais écrire la fonction
-     * récursive privée deleteElement(Node*&, const_reference)
+     * @brief Parcours symétrique des clefs de rang compris dans [i, j[
+     *
+     * @param i: Premier rang visité
+     * @param j: Rang suivant le dernier rang visité, borné par size()
+     * @param f: Fonction appelée par f(key) pour chaque clef, par ordre
+     *           croissant
+     *
+     * @remark Complexité O(log(N) + k) avec k = j - i
      */
-    bool deleteElement(const_reference key) noexcept
+    template <typename Fn>
+    void visit_ranks(size_t i, size_t j, Fn f) const
     {
-        return deleteElement(_root, key);
+        visitRanks(_root, i, std::min(j, size()), f);
     }
 
-private:
     /**
-     * @brief Recherche le noeud minimal
-     * 
-     * @param r: noeud à partir duquel on cherche le noeud minimal
-     * 
-     * @return référence vers le noeud minimal du BST
-     * 
-     * @remark Complexité O(log(N))
+     * @brief Appelle f(key) pour chaque clef, en parallèle
+     *
+     * L'arbre est découpé par rang en tranches de grain clefs grâce à
+     * nbElements, chaque tranche est une tâche de la réserve de threads.
+     * L'ordre des appels n'est pas défini, f doit pouvoir être appelée
+     * simultanément depuis plusieurs threads.
+     *
+     * @param f: Fonction appelée pour chaque clef
+     * @param grain: Nombre de clefs par tâche
+     * @param pool: Réserve de threads à utiliser
+     *
+     * @exception La première exception levée par f
+     *
+     * @remark Complexité O(N) au total, O(N / P + grain + log(N)) en temps
+     *         avec P threads
      */
-    static Node *&findMinNode(Node *&r){
-        if(r->left != nullptr){
-            r->nbElements--;
-            return findMinNode(r->left);
+    template <typename Fn>
+    void parallel_for_each(Fn f, size_t grain = 4096,
+                           WorkStealingPool &pool = WorkStealingPool::instance()) const
+    {
+        grain = std::max<size_t>(grain, 1);
+        size_t n = size();
+        TaskGroup group(pool);
+        for(size_t i = 0; i < n; i += grain){
+            group.run([this, &f, i, grain]() {
+                visit_ranks(i, i + grain, std::ref(f));
+            });
         }
-        return r;
+        group.wait();
     }
 
     /**
-     * @brief Supprime l'élément clef du sous-arbre
-     * 
-     * @param r: Racine du sous-arbre
-     * @param key: Elément à supprimer
-     * 
-     * @remark Complexité O(log(N))
+     * @brief Réduction parallèle des clefs par ordre croissant
+     *
+     * Calcule combine(...combine(combine(init, map(k0)), map(k1))..., map(kN-1))
+     * en regroupant les appels à combine par tranches de grain clefs
+     * traitées en parallèle. combine doit être associative, map et combine
+     * doivent pouvoir être appelées simultanément depuis plusieurs threads.
+     *
+     * @param init: Valeur initiale
+     * @param map: Fonction appliquée à chaque clef, map(key) est convertible en R
+     * @param combine: Opération associative, combine(R, R) est convertible en R
+     * @param grain: Nombre de clefs par tâche
+     * @param pool: Réserve de threads à utiliser
+     *
+     * @exception La première exception levée par map ou combine
+     *
+     * @remark Complexité O(N) au total, O(N / P + grain + N / grain + log(N))
+     *         en temps avec P threads
      */
-    static bool deleteElement(Node *&r, const_reference key) noexcept {
-        if (r == nullptr || !contains(r,key)){
-            return false;
-        }
-        else if (key < r->key){
-            if(deleteElement(r->left, key))
-                r->nbElements--;
-            return true;
+    template <typename R, typename Map, typename Combine>
+    R parallel_reduce(R init, Map map, Combine combine, size_t grain = 4096,
+                      WorkStealingPool &pool = WorkStealingPool::instance()) const
+    {
+        grain = std::max<size_t>(grain, 1);
+        size_t n = size();
+        size_t chunks = (n + grain - 1) / grain;
+        std::vector<R> partial(chunks, init);
+        {
+            TaskGroup group(pool);
+            for(size_t c = 0; c < chunks; ++c){
+                group.run([this, &map, &combine, &partial, c, grain]() {
+                    R &acc = partial[c];
+                    bool first = true;
+                    visit_ranks(c * grain, (c + 1) * grain, [&](const_reference key) {
+                        if(first){
+                            acc = map(key);
+                            first = false;
+                        }else{
+                            acc = combine(acc, map(key));
+                        }
+                    });
+                });
+            }
+            group.wait();
         }
-        else if (key > r->key){
-            if(deleteElement(r->right, key))
-                r->nbElements--;
-            return true;
+        for(size_t c = 0; c < chunks; ++c){
+            init = combine(init, partial[c]);
         }
-        else if (r->key == key){
-            Node *tmp = r;
-            if (r->left == nullptr){
-                std::swap(r, r->right);
-                delete tmp;
-                return true;
-            }
-            else if (r->right == nullptr){
-                std::swap(r, r->left);
-                delete tmp;
-                return true;
-            }
-            else{
-                Node *&min = findMinNode(r->right);
-                size_t nbElems = r->nbElements -1;
-                r = min;
-                min = min->right;
-
-                r->left = tmp->left;
-                r->right = tmp->right;
-
-                r->nbElements = nbElems;
+        return init;
+    }
 
-                delete tmp;
-                return true;
-            }
+private:
+    template <typename Fn>
+    static void visitRange(const Node *r, const_reference lo, const_reference hi, Fn &f)
+    {
+        if(r != nullptr){
+            // le sous-arbre gauche ne contient que des clefs < r->key
+            if(less(lo, r->key))
+                visitRange(r->left, lo, hi, f);
+            if(!less(r->key, lo) && less(r->key, hi))
+                f(r->key);
+            // le sous-arbre droit ne contient que des clefs > r->key
+            if(less(r->key, hi))
+                visitRange(r->right, lo, hi, f);
         }
-        return true;
     }
 
-public:
-    /**
-     * @brief Taille de l'arbre
-     * 
-     * @return Le nombre d'éléments de l'arbre
-     * 
-     * @remark Complexité O(1)
-     */
-    size_t size() const noexcept {
-        return _root ? _root->nbElements : 0;
+    template <typename Fn>
+    static void visitRanks(const Node *r, size_t i, size_t j, Fn &f)
+    {
+        if(r != nullptr && i < j){
+            size_t nbElementsGauche = size(r->left);
+            if(i < nbElementsGauche)
+                visitRanks(r->left, i, std::min(j, nbElementsGauche), f);
+            if(i <= nbElementsGauche && nbElementsGauche < j)
+                f(r->key);
+            if(j > nbElementsGauche + 1)
+                visitRanks(r->right, i > nbElementsGauche + 1 ? i - nbElementsGauche - 1 : 0,
+                           j - nbElementsGauche - 1, f);
+        }
     }
 
+public:
     /**
-     * @brief Cherche la clef en position n
-     * 
-     * @return référence à la clef en position n par ordre croissant des
-     *         éléments
-     * 
-     * @exception std::logic_error (std::out_of_range) si le nombre d'éléments dans 
-     *            l'arbre est inférieur à n
-     * 
-     * @remark Complexité O(log(N))
+     * @brief Image figée de l'arbre, pour les recherches intensives
+     *
+     * @return Un FrozenSearchTree contenant une copie des clefs, rangées
+     *         dans un tableau contigu. Il ne suit pas les modifications
+     *         ultérieures de l'arbre.
+     *
+     * @remark Complexité O(N)
      */
-    const_reference nth_element(size_t n) const {
-        if(_root->nbElements < n){
-            throw std::out_of_range("L'arbre ne contient pas autant d'elements");
-        }
-        return nth_element(_root, n);
+    FrozenSearchTree<value_type, Compare> freeze() const {
+        return FrozenSearchTree<value_type, Compare>(std::vector<value_type>(begin(), end()));
     }
 
-private:
     /**
-     * @brief Clef en position n dans un sous-arbre
-     * 
-     * @param r: Racine du sous-arbre, ne peut être nullptr
-     * @param n: Position n
-     * 
-     * @ return référence à la clef en position n, par ordre croissant des éléments.
-     * 
-     * @remark Complexité O(log(N))
+     * @brief Forme de l'arbre, calculée en un parcours
+     *
+     * Une hauteur ou une profondeur p99 très supérieure à log2(N) signale un
+     * arbre dégénéré, qu'un appel à balance() rendrait plus rapide.
+     *
+     * @remark Complexité O(N), avec une pile de O(h) noeuds. bytes ne
+     *         compte pas le surcoût propre à l'allocateur.
      */
-    static const_reference nth_element(Node *r, size_t n) noexcept {
-        assert(r != nullptr);
-        size_t nbElementsGauche = 0;
-
-        if (r->left){
-            nbElementsGauche = r->left->nbElements;
-        }
-
-        //n-ième élément dans le sous-arbre gauche
-        if (n > nbElementsGauche) {
-            return nth_element(r->right, n - nbElementsGauche - 1);
+    Stats stats() const {
+        Stats s;
+        s.size = size();
+        s.bytes = sizeof(*this) + s.size * sizeof(Node);
+        size_t totalDepth = 0;
+        std::vector<std::pair<const Node *, size_t>> stack;
+        if(_root){
+            stack.push_back(std::make_pair(_root, size_t(0)));
         }
-            //n-ième élément dans le sous-arbre droit
-        else if (n < nbElementsGauche) {
-            return nth_element(r->left, n);
+        while(!stack.empty()){
+            const Node *r = stack.back().first;
+            size_t depth = stack.back().second;
+            stack.pop_back();
+            if(depth == s.depthHistogram.size()){
+                s.depthHistogram.push_back(0);
+            }
+            ++s.depthHistogram[depth];
+            totalDepth += depth;
+            if(r->right)
+                stack.push_back(std::make_pair(r->right, depth + 1));
+            if(r->left)
+                stack.push_back(std::make_pair(r->left, depth + 1));
         }
-            //n-ième élément est la racine
-        else {
-            return r->key;
+        s.height = s.depthHistogram.size();
+        if(s.size){
+            s.averageDepth = double(totalDepth) / double(s.size);
+            s.medianDepth = depthPercentile(s.depthHistogram, s.size, 50);
+            s.p90Depth = depthPercentile(s.depthHistogram, s.size, 90);
+            s.p99Depth = depthPercentile(s.depthHistogram, s.size, 99);
         }
+        return s;
     }
 
-public:
-
     /**
-     * @brief Position d'une clef dans l'ordre croissant des éléments de l'arbre
-     * 
-     * @param key: La clef dont on cherche le rang
-     * 
-     * @return La position entre  0 et size()-1, size_t(-1) si la clef est absente
+     * @brief Vérifie la structure de l'arbre, pour les tests
+     *
+     * @return true si les clefs sont strictement ordonnées selon Compare,
+     *         si chaque nbElements compte son sous-arbre et si les données
+     *         de la politique d'équilibrage respectent ses invariants
+     *         (hauteurs AVL, couleurs rouge-noir, poids alpha)
+     *
+     * @remark Complexité O(N log(N)) au plus, avec une pile de O(h) appels
      */
-    size_t rank(const_reference key) const noexcept {
-        return rank(_root, key);
+    bool checkInvariants() const {
+        return checkInvariants(_root, nullptr, nullptr);
     }
 
-private:
+#ifdef BST_STATS
     /**
-     * @brief Position d'une clef dans l'ordre croissant des éléments du sous-arbre
-     * 
-     * @param key: La clef dont on cherche le rang
-     * @param r: Racine du sous-arbre
-     * 
-     * @return La position entre  0 et size()-1, size_t(-1) si la clef est absente
-     * 
-     * @remark Complexité O(log(N))
+     * @brief Compteurs cumulés d'une sorte d'opération, depuis la
+     *        construction de l'arbre ou le dernier reset_operation_stats()
+     *
+     * @remark Disponible seulement si BST_STATS est défini
      */
-    static size_t rank(Node *r, const_reference key) noexcept
-    {
-        if (contains(r, key) && r!= nullptr) {
-            size_t nbElementsGauche = 0;
+    OperationStats operation_stats(Operation op) const noexcept {
+        const Counters &c = _counters[size_t(op)];
+        OperationStats s;
+        s.calls = c.calls.load(std::memory_order_relaxed);
+        s.comparisons = c.comparisons.load(std::memory_order_relaxed);
+        s.visited = c.visited.load(std::memory_order_relaxed);
+        s.allocations = c.allocations.load(std::memory_order_relaxed);
+        return s;
+    }
 
-            if (r->left) {
-                nbElementsGauche += r->left->nbElements;
-            }
+    void reset_operation_stats() noexcept {
+        for(Counters &c : _counters){
+            c.calls.store(0, std::memory_order_relaxed);
+            c.comparisons.store(0, std::memory_order_relaxed);
+            c.visited.store(0, std::memory_order_relaxed);
+            c.allocations.store(0, std::memory_order_relaxed);
+        }
+    }
+#endif
 
-            if (key > r->key){
-                return rank(r->right, key) + nbElementsGauche + 1;
-            } else if (key < r->key){
-                return rank(r->left, key);
-            }else{
-                return nbElementsGauche;
+private:
+    // plus petite profondeur d'au moins p pour cent des n noeuds
+    static size_t depthPercentile(const std::vector<size_t> &histogram, size_t n,
+                                  size_t p) noexcept {
+        size_t needed = (n * p + 99) / 100;
+        size_t seen = 0;
+        for(size_t depth = 0; depth < histogram.size(); ++depth){
+            seen += histogram[depth];
+            if(seen >= needed){
+                return depth;
             }
         }
-        else{
-            return (size_t)-1;
-        }
+        return histogram.size() - 1;
     }
 
 public:
+
     /**
      * @brief Linéarise l'arbre
      * 
@@ -629,14 +4080,33 @@ private:
      * @remark Complexité O(N)
      */
     static void linearize(Node *tree, Node *&list, size_t &cnt) noexcept {
-        if(tree){
-            linearize(tree->right, list, cnt);
-            tree->right = list;
-            list = tree;
-            list->nbElements = ++cnt;
-            linearize(tree->left, list, cnt);
-            tree->left = nullptr;
+        if(tree == nullptr){
+            return;
+        }
+        size_t n = tree->nbElements;
+        // rotations à droite jusqu'à ce qu'aucun noeud n'ait d'enfant gauche
+        Node *head = nullptr;
+        Node **link = &head;
+        while(tree){
+            if(tree->left){
+                Node *l = tree->left;
+                tree->left = l->right;
+                l->right = tree;
+                tree = l;
+            }else{
+                *link = tree;
+                link = &tree->right;
+                tree = tree->right;
+            }
         }
+        *link = list;
+        // nbElements compte les noeuds jusqu'à la fin de la liste
+        cnt += n;
+        size_t remaining = cnt;
+        for(Node *cur = head; n--; cur = cur->right){
+            cur->nbElements = remaining--;
+        }
+        list = head;
     }
 
 public:
@@ -649,15 +4119,111 @@ public:
      * applique l'algorithme d'equilibrage de l'arbre par linearisation et
      * arborisation
      * Ne pas modifier cette fonction
+     *
+     * Un grand arbre non tracé dont l'allocateur est sans état est équilibré en
+     * parallèle, avec un tableau temporaire de N pointeurs.
      */
     void balance() noexcept {
-        size_t cnt = 0;
-        Node *list = nullptr;
-        linearize(_root, list, cnt);
-        arborize(_root, list, cnt);
+        if(!parallelBalance()){
+            size_t cnt = 0;
+            Node *list = nullptr;
+            linearize(_root, list, cnt);
+            arborize(_root, list, cnt);
+        }
+        Balance::template onRebuild<BinarySearchTree>(_root);
     }
 
 private:
+    /**
+     * @brief Equilibrage parallèle : les noeuds sont rangés par ordre
+     *        croissant dans un tableau, puis reliés en un arbre de même
+     *        forme que celui d'arborize. Les deux étapes se partagent entre
+     *        threads par sous-arbres, leurs tailles étant connues.
+     *
+     * @return false si l'arbre est laissé tel quel, parce qu'il est trop
+     *         petit ou que le tableau n'a pu être alloué
+     *
+     * @remark Complexité O(N) au total, O(N / P + log(N)) en temps avec P
+     *         threads
+     */
+    bool parallelBalance() noexcept {
+        std::vector<Node *> nodes;
+        try{
+            if(!useParallel(size())){
+                return false;
+            }
+            nodes.resize(size());
+        }catch(...){
+            return false;
+        }
+        TaskGroup group(WorkStealingPool::instance());
+        flatten(_root, nodes.data(), group);
+        group.wait();
+        build(_root, nodes.data(), nodes.size(), group);
+        group.wait();
+        augmentSubTree(_root);
+        return true;
+    }
+
+    /**
+     * @brief Range les noeuds du sous-arbre r par ordre croissant dans out.
+     *        Le plus petit des sous-arbres est traité par récursion, ou par
+     *        une tâche s'il est grand, le plus grand par la boucle : la
+     *        profondeur de récursion est en O(log(N)).
+     */
+    static void flatten(Node *r, Node **out, TaskGroup &group) noexcept {
+        while(r){
+            size_t nl = size(r->left);
+            out[nl] = r;
+            Node *small = r->left;
+            Node **smallOut = out;
+            if(size(r->right) < nl){
+                small = r->right;
+                smallOut = out + nl + 1;
+                r = r->left;
+            }else{
+                r = r->right;
+                out += nl + 1;
+            }
+            if(size(small) > parallelGrain()){
+                spawn(group, [small, smallOut, &group]() {
+                    flatten(small, smallOut, group);
+                });
+            }else{
+                flatten(small, smallOut, group);
+            }
+        }
+    }
+
+    /**
+     * @brief Relie les cnt noeuds de nodes en un arbre équilibré de même
+     *        forme que celui d'arborize. Le sous-arbre gauche, le plus
+     *        petit, est construit par récursion ou par une tâche s'il est
+     *        grand, le droit par la boucle.
+     */
+    static void build(Node *&tree, Node *const *nodes, size_t cnt,
+                      TaskGroup &group) noexcept {
+        Node **slot = &tree;
+        while(cnt){
+            size_t nl = (cnt - 1) / 2;
+            Node *root = nodes[nl];
+            root->nbElements = cnt;
+            *slot = root;
+            if(nl > parallelGrain()){
+                Node **left = &root->left;
+                spawn(group, [left, nodes, nl, &group]() {
+                    build(*left, nodes, nl, group);
+                });
+            }else{
+                build(root->left, nodes, nl, group);
+            }
+            slot = &root->right;
+            nodes += nl + 1;
+            cnt /= 2;
+        }
+        *slot = nullptr;
+    }
+
     /**
      * @brief Arborise les cnt premiers éléments d'une liste en un arbre
      * 
@@ -673,17 +4239,39 @@ private:
      * @remark Complexité O(N)
      */
     static void arborize(Node *&tree, Node *&list, size_t cnt) noexcept {
-        if(!cnt){
-            tree = nullptr;
-            return;
+        // sous-arbres dont le sous-arbre gauche est en construction. La taille
+        // est au moins divisée par deux à chaque niveau, la pile est bornée.
+        struct Frame
+        {
+            Node **tree; // emplacement de la racine du sous-arbre
+            size_t cnt;  // nombre de noeuds du sous-arbre
+            Node *rg;    // sous-arbre gauche construit
+        };
+        Frame stack[sizeof(size_t) * CHAR_BIT + 1];
+        size_t top = 0;
+        Node **slot = &tree;
+        for(;;){
+            while(cnt){
+                stack[top] = Frame{slot, cnt, nullptr};
+                slot = &stack[top].rg;
+                cnt = (cnt - 1) / 2;
+                ++top;
+            }
+            *slot = nullptr;
+            if(top == 0){
+                augmentSubTree(tree);
+                return;
+            }
+            // sous-arbre gauche terminé : la tête de liste devient la racine
+            Frame &f = stack[--top];
+            Node *root = list;
+            list = list->right;
+            root->nbElements = f.cnt;
+            root->left = f.rg;
+            *f.tree = root;
+            slot = &root->right;
+            cnt = f.cnt / 2;
         }
-        Node *rg = nullptr;
-        arborize(rg, list, (cnt - 1) / 2);
-        tree = list;
-        tree->nbElements = cnt;
-        tree->left = rg;
-        list = list->right;
-        arborize(tree->right, list, cnt / 2);
     }
 
 public:
@@ -703,11 +4291,18 @@ public:
     
 private:
     template <typename Fn>
-    void visitPre(Node *r, Fn f) {
-        if (r != nullptr){
+    void visitPre(Node *r, Fn &f) {
+        std::vector<Node *> stack;
+        if (r != nullptr)
+            stack.push_back(r);
+        while (!stack.empty()){
+            r = stack.back();
+            stack.pop_back();
             f(r->key);
-            visitPre(r->left, f);
-            visitPre(r->right, f);
+            if (r->right)
+                stack.push_back(r->right);
+            if (r->left)
+                stack.push_back(r->left);
         }
     }
     
@@ -717,8 +4312,10 @@ public:
      * 
      * @param f: Une fonction capable d'être appelée en recevant une clef
      *          en paramètre. Pour le noeud n courant, l'appel sera f(n->key);
+     *          f ne doit pas accéder à l'arbre, qui est modifié temporairement
+     *          pendant le parcours.
      * 
-     * @remark Complexité O(N)
+     * @remark Complexité O(N), sans mémoire supplémentaire (parcours de Morris)
      */
     template <typename Fn>
     void visitSym(Fn f)
@@ -728,13 +4325,41 @@ public:
 
 private:
     template <typename Fn>
-    void visitSym(Node *r, Fn f)
+    void visitSym(Node *r, Fn &f)
     {
-        if (r != nullptr){
-            visitSym(r->left, f);
-            f(r->key);
-            visitSym(r->right, f);
+        // après une exception de f, le parcours continue sans appeler f pour
+        // retirer les liens temporaires, puis l'exception est relancée
+        std::exception_ptr error;
+        auto visit = [&](Node *n) {
+            if (!error){
+                try{
+                    f(n->key);
+                }catch(...){
+                    error = std::current_exception();
+                }
+            }
+        };
+        while (r != nullptr){
+            if (r->left == nullptr){
+                visit(r);
+                r = r->right;
+                continue;
+            }
+            // prédécesseur de r, dont le pointeur right sert de lien de retour
+            Node *pred = r->left;
+            while (pred->right != nullptr && pred->right != r)
+                pred = pred->right;
+            if (pred->right == nullptr){
+                pred->right = r;
+                r = r->left;
+            }else{
+                pred->right = nullptr;
+                visit(r);
+                r = r->right;
+            }
         }
+        if (error)
+            std::rethrow_exception(error);
     }
 
 public:
@@ -754,13 +4379,27 @@ public:
 
 private:
     template <typename Fn>
-    void visitPost(Node *r, Fn f)
+    void visitPost(Node *r, Fn &f)
     {
-        if (r != nullptr)
+        std::vector<Node *> stack;
+        Node *last = nullptr; // dernier noeud visité
+        while (r != nullptr || !stack.empty())
         {
-            visitPost(r->left, f);
-            visitPost(r->right, f);
-            f(r->key);
+            if (r != nullptr)
+            {
+                stack.push_back(r);
+                r = r->left;
+            }
+            else if (stack.back()->right != nullptr && stack.back()->right != last)
+            {
+                r = stack.back()->right;
+            }
+            else
+            {
+                last = stack.back();
+                stack.pop_back();
+                f(last->key);
+            }
         }
     }
 
@@ -849,4 +4488,90 @@ public:
             }
         }
     }
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Union de deux arbres, dans un nouvel arbre
+ *
+ * @remark Complexité O(N + M)
+ */
+template <typename T, typename B, typename A, typename Tr, typename C, typename Au>
+BinarySearchTree<T, B, A, Tr, C, Au> set_union(const BinarySearchTree<T, B, A, Tr, C, Au> &a,
+                                               const BinarySearchTree<T, B, A, Tr, C, Au> &b)
+{
+    const BinarySearchTree<T, B, A, Tr, C, Au> &big = a.size() < b.size() ? b : a;
+    BinarySearchTree<T, B, A, Tr, C, Au> r(big);
+    r.set_union_with(&big == &a ? b : a);
+    return r;
+}
+
+/**
+ * @brief Union de deux arbres, construite avec leurs noeuds
+ *
+ * @remark Complexité O(min(m log(n), N + M))
+ */
+template <typename T, typename B, typename A, typename Tr, typename C, typename Au>
+BinarySearchTree<T, B, A, Tr, C, Au> set_union(BinarySearchTree<T, B, A, Tr, C, Au> &&a,
+                                               BinarySearchTree<T, B, A, Tr, C, Au> &&b)
+{
+    a.set_union_with(std::move(b));
+    return std::move(a);
+}
+
+/**
+ * @brief Intersection de deux arbres, dans un nouvel arbre copié du plus
+ *        petit
+ *
+ * @remark Complexité O(min(m log(n), N + M))
+ */
+template <typename T, typename B, typename A, typename Tr, typename C, typename Au>
+BinarySearchTree<T, B, A, Tr, C, Au> set_intersection(const BinarySearchTree<T, B, A, Tr, C, Au> &a,
+                                                      const BinarySearchTree<T, B, A, Tr, C, Au> &b)
+{
+    const BinarySearchTree<T, B, A, Tr, C, Au> &small = b.size() < a.size() ? b : a;
+    BinarySearchTree<T, B, A, Tr, C, Au> r(small);
+    r.set_intersection_with(&small == &a ? b : a);
+    return r;
+}
+
+/**
+ * @brief Intersection de deux arbres, construite avec les noeuds de a
+ *
+ * @remark Complexité O(min(N log(M), N + M))
+ */
+template <typename T, typename B, typename A, typename Tr, typename C, typename Au>
+BinarySearchTree<T, B, A, Tr, C, Au> set_intersection(BinarySearchTree<T, B, A, Tr, C, Au> &&a,
+                                                      const BinarySearchTree<T, B, A, Tr, C, Au> &b)
+{
+    a.set_intersection_with(b);
+    return std::move(a);
+}
+
+/**
+ * @brief Clefs de a absentes de b, dans un nouvel arbre
+ *
+ * @remark Complexité O(N + min(M log(N), N log(M), N + M))
+ */
+template <typename T, typename B, typename A, typename Tr, typename C, typename Au>
+BinarySearchTree<T, B, A, Tr, C, Au> set_difference(const BinarySearchTree<T, B, A, Tr, C, Au> &a,
+                                                    const BinarySearchTree<T, B, A, Tr, C, Au> &b)
+{
+    BinarySearchTree<T, B, A, Tr, C, Au> r(a);
+    r.set_difference_with(b);
+    return r;
+}
+
+/**
+ * @brief Clefs de a absentes de b, construites avec les noeuds de a
+ *
+ * @remark Complexité O(min(M log(N), N log(M), N + M))
+ */
+template <typename T, typename B, typename A, typename Tr, typename C, typename Au>
+BinarySearchTree<T, B, A, Tr, C, Au> set_difference(BinarySearchTree<T, B, A, Tr, C, Au> &&a,
+                                                    const BinarySearchTree<T, B, A, Tr, C, Au> &b)
+{
+    a.set_difference_with(b);
+    return std::move(a);
+}
+
+#endif
@@ -0,0 +1,924 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : btree.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Arbre B de statistiques d'ordre, de même interface que
+               BinarySearchTree.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Dans les complexités, N fait référence au nombre de clefs
+               présentes dans l'arbre. Les déplacements de T (constructeur
+               et affectation par déplacement) ne doivent pas lever
+               d'exception.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef BTREE_CPP
+#define BTREE_CPP
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ *  @brief Arbre B de degré minimal B : chaque noeud, sauf la racine, contient
+ *         entre B-1 et 2B-1 clefs et toutes les feuilles sont à la même
+ *         profondeur.
+ *
+ *  Un noeud interne mémorise le nombre de clefs du sous-arbre de chacun de
+ *  ses enfants, rank et nth_element restent donc en O(log(N)). Insertion et
+ *  suppression se font en une seule descente : les noeuds pleins sont
+ *  scindés avant d'y entrer (insertion), les noeuds minimaux sont complétés
+ *  par un voisin ou fusionnés avant d'y entrer (suppression). La
+ *  suppression cherche d'abord le rang de la clef puis descend par les
+ *  tailles des sous-arbres : une exception de Compare ne peut donc
+ *  interrompre une fusion.
+ *
+ *  @tparam B: degré minimal
+ *  @tparam Compare: ordre strict des clefs, objet fonction sans état
+ */
+template <typename T, size_t B = 16, typename Compare = std::less<T>>
+class BTree
+{
+    static_assert(B >= 2, "Le degre minimal d'un arbre B est au moins 2");
+
+public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using key_compare = Compare;
+
+private:
+    static const size_t MaxKeys = 2 * B - 1;
+    static const size_t MinKeys = B - 1;
+
+    /**
+     *  @brief Feuille : jusqu'à MaxKeys clefs triées, construites dans un
+     *         stockage brut pour ne pas exiger de constructeur par défaut.
+     */
+    struct Leaf
+    {
+        size_t n;  // nombre de clefs
+        bool leaf; // false pour un Inner
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[MaxKeys];
+
+        explicit Leaf(bool leaf = true) noexcept : n(0), leaf(leaf)
+        {
+        }
+
+        T &key(size_t i) noexcept
+        {
+            return *reinterpret_cast<T *>(&slots[i]);
+        }
+
+        const T &key(size_t i) const noexcept
+        {
+            return *reinterpret_cast<const T *>(&slots[i]);
+        }
+
+        void *slot(size_t i) noexcept
+        {
+            return &slots[i];
+        }
+    };
+
+    /**
+     *  @brief Noeud interne : n clefs, n+1 enfants et la taille de chacun
+     *         de leurs sous-arbres
+     */
+    struct Inner : Leaf
+    {
+        Leaf *child[MaxKeys + 1];
+        size_t count[MaxKeys + 1];
+
+        Inner() noexcept : Leaf(false)
+        {
+            // une copie interrompue est détruite avant d'avoir tous ses enfants
+            std::fill(child, child + MaxKeys + 1, nullptr);
+        }
+    };
+
+    Leaf *_root;
+    size_t _size;
+
+public:
+    /**
+     *  @brief Constructeur par défaut. Construit un arbre vide
+     */
+    BTree() noexcept : _root(nullptr), _size(0)
+    {
+    }
+
+    /**
+     *  @brief Constucteur de copie
+     *
+     *  @remark Complexité : O(N)
+     */
+    BTree(const BTree &other) : _root(nullptr), _size(0)
+    {
+        if (other._root)
+        {
+            _root = clone(other._root);
+            _size = other._size;
+        }
+    }
+
+    /**
+     *  @brief Opérateur d'affectation par copie
+     *
+     *  @remark Complexité : O(N + M), garantie forte
+     */
+    BTree &operator=(const BTree &other)
+    {
+        if (this != &other)
+        {
+            BTree copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    /**
+     *  @brief Constructeur de déplacement
+     *
+     *  @remark Complexité : O(1)
+     */
+    BTree(BTree &&other) noexcept : _root(other._root), _size(other._size)
+    {
+        other._root = nullptr;
+        other._size = 0;
+    }
+
+    /**
+     *  @brief Opérateur d'affectation par déplacement
+     *
+     *  @remark Complexité : O(N) pour libérer les anciennes clefs
+     */
+    BTree &operator=(BTree &&other) noexcept
+    {
+        BTree tmp(std::move(other));
+        swap(tmp);
+        return *this;
+    }
+
+    /**
+     *  @brief Echange le contenu avec un autre BTree
+     *
+     *  @remark Complexité : O(1)
+     */
+    void swap(BTree &other) noexcept
+    {
+        std::swap(_root, other._root);
+        std::swap(_size, other._size);
+    }
+
+    /**
+     *  @brief Destructeur
+     *
+     *  @remark Complexité : O(N)
+     */
+    ~BTree()
+    {
+        clear();
+    }
+
+    /**
+     *  @brief Vide l'arbre
+     *
+     *  @remark Complexité : O(N)
+     */
+    void clear() noexcept
+    {
+        destroy(_root);
+        _root = nullptr;
+        _size = 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Insertion d'une clef dans l'arbre
+     *
+     * @param key: la clef à insérer. Rien n'est fait si elle est déjà présente.
+     *
+     * @remark Complexité O(B log(N)), garantie forte
+     */
+    void insert(const_reference key)
+    {
+        if (contains(key))
+        {
+            return;
+        }
+        if (_root == nullptr)
+        {
+            Leaf *leaf = new Leaf;
+            try
+            {
+                ::new (leaf->slot(0)) T(key);
+            }
+            catch (...)
+            {
+                delete leaf;
+                throw;
+            }
+            leaf->n = 1;
+            _root = leaf;
+            _size = 1;
+            return;
+        }
+
+        T k(key);
+        if (_root->n == MaxKeys)
+        {
+            Inner *s = new Inner;
+            s->child[0] = _root;
+            s->count[0] = _size;
+            try
+            {
+                splitChild(s, 0);
+            }
+            catch (...)
+            {
+                delete s;
+                throw;
+            }
+            _root = s;
+        }
+
+        // les compteurs du chemin ne sont mis à jour qu'une fois la clef
+        // placée : une scission qui échoue laisse l'arbre intact
+        Inner *path[sizeof(size_t) * CHAR_BIT];
+        size_t idx[sizeof(size_t) * CHAR_BIT];
+        size_t depth = 0;
+        Leaf *x = _root;
+        while (!x->leaf)
+        {
+            Inner *in = static_cast<Inner *>(x);
+            size_t i = lowerIndex(in, k);
+            if (in->child[i]->n == MaxKeys)
+            {
+                splitChild(in, i);
+                if (less(in->key(i), k))
+                {
+                    ++i;
+                }
+            }
+            path[depth] = in;
+            idx[depth] = i;
+            ++depth;
+            x = in->child[i];
+        }
+        insertKey(x, lowerIndex(x, k), std::move(k));
+        for (size_t d = 0; d < depth; ++d)
+        {
+            ++path[d]->count[idx[d]];
+        }
+        ++_size;
+    }
+
+    /**
+     * @brief Recherche d'une clef
+     *
+     * @return true si clef trouvée, false dans le cas contraire
+     *
+     * @remark Complexité O(log(B) log(N))
+     */
+    bool contains(const_reference key) const noexcept(nothrowLess())
+    {
+        const Leaf *x = _root;
+        while (x)
+        {
+            size_t i = lowerIndex(x, key);
+            if (i < x->n && !less(key, x->key(i)))
+            {
+                return true;
+            }
+            x = x->leaf ? nullptr : static_cast<const Inner *>(x)->child[i];
+        }
+        return false;
+    }
+
+    /**
+     * @brief Recherche de la clef minimale
+     *
+     * @exception std::logic_error si l'arbre est vide
+     *
+     * @remark Complexité O(log(N))
+     */
+    const_reference min() const
+    {
+        if (_root == nullptr)
+        {
+            throw std::logic_error("L'arbre est vide, il n'y a donc pas de minimum");
+        }
+        const Leaf *x = _root;
+        while (!x->leaf)
+        {
+            x = static_cast<const Inner *>(x)->child[0];
+        }
+        return x->key(0);
+    }
+
+    /**
+     * @brief Supprime le plus petit élément de l'arbre
+     *
+     * @exception std::logic_error si l'arbre est vide
+     *
+     * @remark Complexité O(B log(N))
+     */
+    void deleteMin()
+    {
+        if (_root == nullptr)
+        {
+            throw std::logic_error("Arbre vide il n'est pas possible de delete le min");
+        }
+        remove(_root, 0);
+        --_size;
+    }
+
+    /**
+     * @brief Supprime l'élément de la clef de l'arbre
+     *
+     * @param key: Clef de l'élément à supprimer
+     *
+     * @return true si la clef était présente
+     *
+     * @remark Complexité O(B log(N)), garantie forte
+     */
+    bool deleteElement(const_reference key) noexcept(nothrowLess())
+    {
+        size_t r = rank(key);
+        if (r == size_t(-1))
+        {
+            return false;
+        }
+        remove(_root, r);
+        --_size;
+        return true;
+    }
+
+    /**
+     * @brief Cherche la clef en position n
+     *
+     * @exception std::out_of_range si n >= size()
+     *
+     * @remark Complexité O(B log(N))
+     */
+    const_reference nth_element(size_t n) const
+    {
+        if (n >= _size)
+        {
+            throw std::out_of_range("L'arbre ne contient pas autant d'elements");
+        }
+        const Leaf *x = _root;
+        while (!x->leaf)
+        {
+            const Inner *in = static_cast<const Inner *>(x);
+            size_t i = 0;
+            for (; n >= in->count[i]; ++i)
+            {
+                n -= in->count[i];
+                if (n == 0)
+                {
+                    return in->key(i);
+                }
+                --n;
+            }
+            x = in->child[i];
+        }
+        return x->key(n);
+    }
+
+    /**
+     * @brief Position d'une clef dans l'ordre croissant des éléments
+     *
+     * @return La position entre 0 et size()-1, size_t(-1) si la clef est absente
+     *
+     * @remark Complexité O(B log(N))
+     */
+    size_t rank(const_reference key) const noexcept(nothrowLess())
+    {
+        size_t before = 0; // clefs inférieures hors du sous-arbre de x
+        const Leaf *x = _root;
+        while (x)
+        {
+            size_t i = lowerIndex(x, key);
+            bool found = i < x->n && !less(key, x->key(i));
+            if (x->leaf)
+            {
+                return found ? before + i : size_t(-1);
+            }
+            const Inner *in = static_cast<const Inner *>(x);
+            for (size_t j = 0; j < i; ++j)
+            {
+                before += in->count[j] + 1;
+            }
+            if (found)
+            {
+                return before + in->count[i];
+            }
+            x = in->child[i];
+        }
+        return size_t(-1);
+    }
+
+    /**
+     * @brief Parcours pré-ordonné : les clefs d'un noeud, puis ses enfants
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename Fn>
+    void visitPre(Fn f) const
+    {
+        visitPre(_root, f);
+    }
+
+    /**
+     * @brief Parcours symétrique : les clefs par ordre croissant
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename Fn>
+    void visitSym(Fn f) const
+    {
+        visitSym(_root, f);
+    }
+
+    /**
+     * @brief Parcours post-ordonné : les enfants d'un noeud, puis ses clefs
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename Fn>
+    void visitPost(Fn f) const
+    {
+        visitPost(_root, f);
+    }
+
+private:
+    // les parcours sont récursifs : la hauteur d'un arbre B est en O(log(N))
+    template <typename Fn>
+    static void visitPre(const Leaf *x, Fn &f)
+    {
+        if (x)
+        {
+            for (size_t i = 0; i < x->n; ++i)
+            {
+                f(x->key(i));
+            }
+            if (!x->leaf)
+            {
+                for (size_t i = 0; i <= x->n; ++i)
+                {
+                    visitPre(static_cast<const Inner *>(x)->child[i], f);
+                }
+            }
+        }
+    }
+
+    template <typename Fn>
+    static void visitSym(const Leaf *x, Fn &f)
+    {
+        if (x)
+        {
+            for (size_t i = 0; i < x->n; ++i)
+            {
+                if (!x->leaf)
+                {
+                    visitSym(static_cast<const Inner *>(x)->child[i], f);
+                }
+                f(x->key(i));
+            }
+            if (!x->leaf)
+            {
+                visitSym(static_cast<const Inner *>(x)->child[x->n], f);
+            }
+        }
+    }
+
+    template <typename Fn>
+    static void visitPost(const Leaf *x, Fn &f)
+    {
+        if (x)
+        {
+            if (!x->leaf)
+            {
+                for (size_t i = 0; i <= x->n; ++i)
+                {
+                    visitPost(static_cast<const Inner *>(x)->child[i], f);
+                }
+            }
+            for (size_t i = 0; i < x->n; ++i)
+            {
+                f(x->key(i));
+            }
+        }
+    }
+
+    // a < b selon Compare
+    static bool less(const_reference a, const_reference b) noexcept(nothrowLess())
+    {
+        return Compare()(a, b);
+    }
+
+    // vrai si Compare ne peut lever d'exception
+    static constexpr bool nothrowLess() noexcept
+    {
+        return noexcept(Compare()(std::declval<const T &>(), std::declval<const T &>()));
+    }
+
+    // nombre de clefs de x inférieures à key
+    static size_t lowerIndex(const Leaf *x, const_reference key) noexcept(nothrowLess())
+    {
+        size_t lo = 0, hi = x->n;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (less(x->key(mid), key))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // nombre de clefs du sous-arbre x
+    static size_t weight(const Leaf *x) noexcept
+    {
+        size_t w = x->n;
+        if (!x->leaf)
+        {
+            const Inner *in = static_cast<const Inner *>(x);
+            for (size_t i = 0; i <= x->n; ++i)
+            {
+                w += in->count[i];
+            }
+        }
+        return w;
+    }
+
+    // construit dans dst la clef src, déplacée, puis détruit src
+    static void relocate(Leaf *dst, size_t d, Leaf *src, size_t s) noexcept
+    {
+        ::new (dst->slot(d)) T(std::move(src->key(s)));
+        src->key(s).~T();
+    }
+
+    // insère k en position i de x, qui n'est pas plein
+    static void insertKey(Leaf *x, size_t i, T &&k) noexcept
+    {
+        for (size_t j = x->n; j > i; --j)
+        {
+            relocate(x, j, x, j - 1);
+        }
+        ::new (x->slot(i)) T(std::move(k));
+        ++x->n;
+    }
+
+    // retire la clef en position i de x et la renvoie
+    static T eraseKey(Leaf *x, size_t i) noexcept
+    {
+        T k(std::move(x->key(i)));
+        x->key(i).~T();
+        for (size_t j = i + 1; j < x->n; ++j)
+        {
+            relocate(x, j - 1, x, j);
+        }
+        --x->n;
+        return k;
+    }
+
+    // insère l'enfant c de taille w en position i de p (avant la clef i)
+    static void insertChild(Inner *p, size_t i, Leaf *c, size_t w) noexcept
+    {
+        for (size_t j = p->n + 1; j > i; --j)
+        {
+            p->child[j] = p->child[j - 1];
+            p->count[j] = p->count[j - 1];
+        }
+        p->child[i] = c;
+        p->count[i] = w;
+    }
+
+    // retire l'enfant en position i de p, déjà privé d'une clef
+    static void eraseChild(Inner *p, size_t i) noexcept
+    {
+        for (size_t j = i; j <= p->n; ++j)
+        {
+            p->child[j] = p->child[j + 1];
+            p->count[j] = p->count[j + 1];
+        }
+    }
+
+    /**
+     * @brief Scinde l'enfant plein i de p : sa clef médiane monte dans p et
+     *        ses B-1 dernières clefs passent dans un nouveau frère droit
+     *
+     * @exception std::bad_alloc, avant toute modification
+     */
+    static void splitChild(Inner *p, size_t i)
+    {
+        Leaf *y = p->child[i];
+        Leaf *z = y->leaf ? new Leaf : static_cast<Leaf *>(new Inner);
+        for (size_t j = 0; j < MinKeys; ++j)
+        {
+            relocate(z, j, y, B + j);
+        }
+        z->n = MinKeys;
+        if (!y->leaf)
+        {
+            Inner *yi = static_cast<Inner *>(y);
+            Inner *zi = static_cast<Inner *>(z);
+            for (size_t j = 0; j < B; ++j)
+            {
+                zi->child[j] = yi->child[B + j];
+                zi->count[j] = yi->count[B + j];
+            }
+        }
+        y->n = B;
+        size_t w = weight(z);
+        insertChild(p, i + 1, z, w);
+        insertKey(p, i, eraseKey(y, MinKeys));
+        p->count[i] -= w + 1;
+    }
+
+    /**
+     * @brief Fusionne les enfants i et i+1 de p, qui ont B-1 clefs, autour de
+     *        la clef i de p
+     */
+    static void merge(Inner *p, size_t i) noexcept
+    {
+        Leaf *l = p->child[i];
+        Leaf *r = p->child[i + 1];
+        size_t w = p->count[i + 1];
+        ::new (l->slot(l->n)) T(eraseKey(p, i));
+        for (size_t j = 0; j < r->n; ++j)
+        {
+            relocate(l, l->n + 1 + j, r, j);
+        }
+        if (!l->leaf)
+        {
+            Inner *li = static_cast<Inner *>(l);
+            Inner *ri = static_cast<Inner *>(r);
+            for (size_t j = 0; j <= r->n; ++j)
+            {
+                li->child[l->n + 1 + j] = ri->child[j];
+                li->count[l->n + 1 + j] = ri->count[j];
+            }
+        }
+        l->n += 1 + r->n;
+        r->n = 0;
+        eraseChild(p, i + 1);
+        p->count[i] += w + 1;
+        deleteNode(r);
+    }
+
+    // l'enfant c de p reçoit la clef c-1 de p, remplacée par la dernière
+    // clef de son frère gauche
+    static void borrowFromLeft(Inner *p, size_t c) noexcept
+    {
+        Leaf *l = p->child[c - 1];
+        Leaf *x = p->child[c];
+        size_t w = 0;
+        if (!x->leaf)
+        {
+            Inner *li = static_cast<Inner *>(l);
+            w = li->count[l->n];
+            insertChild(static_cast<Inner *>(x), 0, li->child[l->n], w);
+        }
+        insertKey(x, 0, eraseKey(p, c - 1));
+        insertKey(p, c - 1, eraseKey(l, l->n - 1));
+        p->count[c - 1] -= w + 1;
+        p->count[c] += w + 1;
+    }
+
+    // l'enfant c de p reçoit la clef c de p, remplacée par la première clef
+    // de son frère droit
+    static void borrowFromRight(Inner *p, size_t c) noexcept
+    {
+        Leaf *x = p->child[c];
+        Leaf *r = p->child[c + 1];
+        size_t w = 0;
+        insertKey(x, x->n, eraseKey(p, c));
+        T k = eraseKey(r, 0);
+        if (!x->leaf)
+        {
+            Inner *xi = static_cast<Inner *>(x);
+            Inner *ri = static_cast<Inner *>(r);
+            w = ri->count[0];
+            xi->child[x->n] = ri->child[0];
+            xi->count[x->n] = w;
+            eraseChild(ri, 0);
+        }
+        insertKey(p, c, std::move(k));
+        p->count[c] += w + 1;
+        p->count[c + 1] -= w + 1;
+    }
+
+    /**
+     * @brief Clef ou enfant de x contenant la position pos du sous-arbre x
+     *
+     * @param pos: Position dans x, devient la position dans l'enfant
+     * @param found: Mis à true si la position est celle d'une clef de x
+     *
+     * @return L'indice de la clef ou de l'enfant
+     */
+    static size_t locate(const Leaf *x, size_t &pos, bool &found) noexcept
+    {
+        if (x->leaf)
+        {
+            found = true;
+            return pos;
+        }
+        const Inner *in = static_cast<const Inner *>(x);
+        size_t i = 0;
+        for (; pos > in->count[i]; ++i)
+        {
+            pos -= in->count[i] + 1;
+        }
+        found = pos == in->count[i];
+        return i;
+    }
+
+    /**
+     * @brief Retire la clef en position pos du sous-arbre x en une seule
+     *        descente et la renvoie. Avant d'entrer dans un enfant de B-1
+     *        clefs, celui-ci emprunte une clef à un frère ou est fusionné
+     *        avec lui. La descente suit les tailles des sous-arbres, sans
+     *        comparer de clefs.
+     *
+     * @param x: Racine du sous-arbre, _root ou un noeud d'au moins B clefs
+     * @param pos: Position de la clef dans le sous-arbre, inférieure à sa taille
+     */
+    T remove(Leaf *x, size_t pos) noexcept
+    {
+        for (;;)
+        {
+            bool found;
+            size_t p = pos;
+            size_t i = locate(x, p, found);
+            if (x->leaf)
+            {
+                T k = eraseKey(x, i);
+                if (x == _root && x->n == 0)
+                {
+                    deleteNode(x);
+                    _root = nullptr;
+                }
+                return k;
+            }
+            Inner *in = static_cast<Inner *>(x);
+            if (found && in->child[i]->n > MinKeys)
+            {
+                // remplacée par son prédécesseur, dernière clef de l'enfant i
+                T pred = remove(in->child[i], --in->count[i]);
+                T k(std::move(in->key(i)));
+                in->key(i) = std::move(pred);
+                return k;
+            }
+            if (found && in->child[i + 1]->n > MinKeys)
+            {
+                // remplacée par son successeur
+                --in->count[i + 1];
+                T succ = remove(in->child[i + 1], 0);
+                T k(std::move(in->key(i)));
+                in->key(i) = std::move(succ);
+                return k;
+            }
+            if (!found && in->child[i]->n == MinKeys)
+            {
+                if (i > 0 && in->child[i - 1]->n > MinKeys)
+                {
+                    borrowFromLeft(in, i);
+                }
+                else if (i < in->n && in->child[i + 1]->n > MinKeys)
+                {
+                    borrowFromRight(in, i);
+                }
+                else if (i < in->n)
+                {
+                    merge(in, i);
+                }
+                else
+                {
+                    merge(in, i - 1);
+                }
+            }
+            else if (found)
+            {
+                // la clef descend dans la fusion de ses deux enfants
+                merge(in, i);
+            }
+            if (in->n == 0)
+            {
+                // la racine a été vidée par une fusion : l'arbre perd un niveau
+                _root = in->child[0];
+                deleteNode(in);
+                x = _root;
+                continue;
+            }
+            // les emprunts et fusions ont déplacé la clef dans un enfant
+            p = pos;
+            i = locate(in, p, found);
+            --in->count[i];
+            x = in->child[i];
+            pos = p;
+        }
+    }
+
+    static void deleteNode(Leaf *x) noexcept
+    {
+        if (x->leaf)
+        {
+            delete x;
+        }
+        else
+        {
+            delete static_cast<Inner *>(x);
+        }
+    }
+
+    /**
+     * @brief Détruit le sous-arbre x, peut être nullptr, ainsi que ses
+     *        enfants non nuls
+     *
+     * @remark Complexité O(N), récursion en O(log(N))
+     */
+    static void destroy(Leaf *x) noexcept
+    {
+        if (x)
+        {
+            for (size_t i = 0; i < x->n; ++i)
+            {
+                x->key(i).~T();
+            }
+            if (!x->leaf)
+            {
+                Inner *in = static_cast<Inner *>(x);
+                for (size_t i = 0; i <= x->n; ++i)
+                {
+                    destroy(in->child[i]);
+                }
+            }
+            deleteNode(x);
+        }
+    }
+
+    /**
+     * @brief Copie du sous-arbre x. Si une copie échoue, ce qui a été créé
+     *        est détruit avant de relancer l'exception.
+     *
+     * @remark Complexité O(N)
+     */
+    static Leaf *clone(const Leaf *x)
+    {
+        Leaf *c = x->leaf ? new Leaf : static_cast<Leaf *>(new Inner);
+        try
+        {
+            for (; c->n < x->n; ++c->n)
+            {
+                ::new (c->slot(c->n)) T(x->key(c->n));
+            }
+            if (!x->leaf)
+            {
+                const Inner *xi = static_cast<const Inner *>(x);
+                Inner *ci = static_cast<Inner *>(c);
+                for (size_t i = 0; i <= x->n; ++i)
+                {
+                    ci->child[i] = clone(xi->child[i]);
+                    ci->count[i] = xi->count[i];
+                }
+            }
+        }
+        catch (...)
+        {
+            destroy(c);
+            throw;
+        }
+        return c;
+    }
+};
+
+template <typename T, size_t B, typename Compare>
+const size_t BTree<T, B, Compare>::MaxKeys;
+
+template <typename T, size_t B, typename Compare>
+const size_t BTree<T, B, Compare>::MinKeys;
+
+#endif
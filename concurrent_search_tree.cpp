@@ -0,0 +1,659 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : concurrent_search_tree.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Arbre binaire de recherche partagé entre threads : lectures
+               sans verrou, écritures verrouillant noeud par noeud.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : L'arbre est un treap : chaque noeud reçoit une priorité
+               aléatoire et les priorités décroissent de la racine vers les
+               feuilles, ce qui le garde de hauteur O(log(N)) en moyenne
+               sans rotation remontante. Une écriture descend de la racine
+               en verrouillant chaque noeud avant de relâcher son parent et
+               ne garde ensuite verrouillée que la partie qu'elle
+               restructure. Les lecteurs valident le numéro de version de
+               chaque noeud traversé, les noeuds supprimés sont détruits par
+               le domaine d'époques.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef CONCURRENT_SEARCH_TREE_CPP
+#define CONCURRENT_SEARCH_TREE_CPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "epoch_domain.cpp"
+
+/**
+ *  @brief Arbre de recherche utilisable simultanément par plusieurs threads.
+ *
+ *  contains, rank, nth_element, size et min descendent sans verrou ni
+ *  écriture partagée. Chaque noeud porte un numéro de version, impair
+ *  pendant qu'une écriture modifie ses enfants : un lecteur relit la
+ *  version d'un noeud après avoir lu celle de son enfant, et recommence à
+ *  la racine si elle a changé.
+ *
+ *  insert et deleteElement descendent en verrouillant chaque noeud avant de
+ *  relâcher son parent, puis ne gardent que le parent du point de
+ *  modification et les noeuds déplacés : O(1) noeuds en moyenne dans un
+ *  treap. Deux écritures dans des sous-arbres disjoints ne partagent donc
+ *  que le passage par les noeuds du haut de l'arbre, un verrou à la fois.
+ *
+ *  nbElements ne peut être recalculé à partir des enfants pendant que
+ *  d'autres écritures passent. Une insertion place d'abord le noeud, sans
+ *  le compter, puis redescend de la racine vers lui en ajoutant 1 à chaque
+ *  noeud traversé, lui compris ; une suppression retire de même 1 à chaque
+ *  ancêtre avant de détacher le noeud. Une restructuration ne recalcule que
+ *  les noeuds qu'elle verrouille, à partir des tailles de leurs enfants,
+ *  qu'aucune autre écriture ne peut modifier sans passer par eux.
+ *  size, rank et nth_element sont donc exacts quand aucune écriture n'est
+ *  en cours, et sinon reflètent un état où chaque taille a été lue à un
+ *  instant différent.
+ */
+template <typename T>
+class ConcurrentSearchTree
+{
+public:
+    using value_type = T;
+    using const_reference = const T &;
+
+private:
+    // verrou d'un noeud, tenu le temps de quelques lectures et écritures
+    class SpinLock
+    {
+        std::atomic<bool> held{false};
+
+    public:
+        void lock() noexcept
+        {
+            while (held.exchange(true, std::memory_order_acquire))
+            {
+                while (held.load(std::memory_order_relaxed))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void unlock() noexcept
+        {
+            held.store(false, std::memory_order_release);
+        }
+    };
+
+    struct Node;
+
+    // partie commune aux noeuds et à la tête, dont l'enfant gauche est la racine
+    struct Link
+    {
+        SpinLock lock;
+        std::atomic<uint64_t> version{0}; // impair pendant une modification
+        std::atomic<Node *> left{nullptr};
+        std::atomic<Node *> right{nullptr};
+    };
+
+    struct Node : Link, EpochDomain::Retired
+    {
+        const value_type key;
+        const uint32_t priority;      // supérieure à celles des descendants
+        std::atomic<size_t> count{0}; // insertions comptées, voir countInsertion
+        std::atomic<bool> counted{false};  // comptée par tous ses ancêtres
+        std::atomic<bool> deleting{false}; // clef logiquement absente
+
+        Node(const_reference key, uint32_t priority) : key(key), priority(priority)
+        {
+        }
+    };
+
+    // résultat du placement d'un noeud
+    enum class Placement
+    {
+        Linked,  // attaché, reste à le compter
+        Present, // clef déjà présente
+        Busy     // clef en cours de suppression, à retenter
+    };
+
+    // noeud verrouillé par une restructuration et sa propre contribution
+    // à count, calculée avant de modifier ses enfants
+    struct Moved
+    {
+        Node *node;
+        size_t own;
+    };
+
+    Link _head;
+    EpochDomain &domain;
+
+public:
+    ConcurrentSearchTree() : domain(EpochDomain::instance())
+    {
+    }
+
+    ConcurrentSearchTree(const ConcurrentSearchTree &) = delete;
+    ConcurrentSearchTree &operator=(const ConcurrentSearchTree &) = delete;
+
+    /**
+     *  @brief Destructeur. Aucun autre thread ne doit plus utiliser l'arbre.
+     */
+    ~ConcurrentSearchTree()
+    {
+        std::vector<Node *> stack;
+        if (Node *root = _head.left.load())
+        {
+            stack.push_back(root);
+        }
+        while (!stack.empty())
+        {
+            Node *x = stack.back();
+            stack.pop_back();
+            if (Node *l = x->left.load())
+            {
+                stack.push_back(l);
+            }
+            if (Node *r = x->right.load())
+            {
+                stack.push_back(r);
+            }
+            delete x;
+        }
+    }
+
+    /**
+     * @brief Insertion d'une clef dans l'arbre
+     *
+     * @remark Complexité O(log(N)) en moyenne, garantie forte
+     */
+    void insert(const_reference key)
+    {
+        std::unique_ptr<Node> n(new Node(key, randomPriority()));
+        for (;;)
+        {
+            switch (place(n.get()))
+            {
+            case Placement::Linked:
+                countInsertion(n.release());
+                return;
+            case Placement::Present:
+                return;
+            case Placement::Busy:
+                std::this_thread::yield();
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Supprime l'élément de la clef de l'arbre
+     *
+     * @return true si la clef était présente
+     *
+     * @remark Complexité O(log(N)) en moyenne
+     */
+    bool deleteElement(const_reference key)
+    {
+        EpochDomain::Guard guard(domain);
+        Node *d;
+        for (;;)
+        {
+            d = const_cast<Node *>(find(key));
+            if (d == nullptr)
+            {
+                return false;
+            }
+            d->lock.lock();
+            bool deleting = d->deleting.load(), counted = d->counted.load();
+            if (!deleting && counted)
+            {
+                d->deleting.store(true);
+            }
+            d->lock.unlock();
+            if (deleting)
+            {
+                return false; // supprimée par un autre thread depuis find
+            }
+            if (counted)
+            {
+                break;
+            }
+            std::this_thread::yield(); // son insertion n'est pas terminée
+        }
+        unlink(d);
+        domain.retire(d);
+        return true;
+    }
+
+    /**
+     * @brief Recherche d'une clef, sans verrou
+     *
+     * @remark Complexité O(log(N)) en moyenne
+     */
+    bool contains(const_reference key) const
+    {
+        EpochDomain::Guard guard(domain);
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Position d'une clef, sans verrou
+     *
+     * @return La position entre 0 et size()-1, size_t(-1) si la clef est absente
+     *
+     * @remark Complexité O(log(N)) en moyenne
+     */
+    size_t rank(const_reference key) const
+    {
+        EpochDomain::Guard guard(domain);
+        size_t before = 0;
+        const Node *x = descend([&before] { before = 0; },
+                                [&key, &before](const Node *x) {
+                                    int c = compare(key, x->key);
+                                    if (c > 0)
+                                    {
+                                        before += count(x) - count(x->right.load());
+                                    }
+                                    return c;
+                                });
+        if (x == nullptr || x->deleting.load())
+        {
+            return size_t(-1);
+        }
+        return before + count(x->left.load());
+    }
+
+    /**
+     * @brief Copie de la clef en position n, sans verrou. Une référence
+     *        pourrait survivre au noeud qu'elle désigne.
+     *
+     * @exception std::out_of_range si n >= size()
+     *
+     * @remark Complexité O(log(N)) en moyenne
+     */
+    value_type nth_element(size_t n) const
+    {
+        EpochDomain::Guard guard(domain);
+        for (;;)
+        {
+            if (n >= count(_head.left.load()))
+            {
+                throw std::out_of_range("nth_element");
+            }
+            size_t m = n;
+            const Node *x = descend([&m, n] { m = n; },
+                                    [&m](const Node *x) {
+                                        size_t nl = count(x->left.load());
+                                        size_t below = nl + count(x->right.load());
+                                        size_t own = count(x) > below ? 1 : 0;
+                                        if (m < nl) return -1;
+                                        if (m < nl + own) return 0;
+                                        m -= nl + own;
+                                        return 1;
+                                    });
+            if (x != nullptr)
+            {
+                return x->key;
+            }
+            // tailles lues pendant une écriture : la descente est sortie de l'arbre
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Copie de la clef minimale, sans verrou
+     *
+     * @exception std::logic_error si l'arbre est vide
+     *
+     * @remark Complexité O(log(N)) en moyenne
+     */
+    value_type min() const
+    {
+        EpochDomain::Guard guard(domain);
+        for (;;)
+        {
+            const Node *last = nullptr;
+            descend([&last] { last = nullptr; },
+                    [&last](const Node *x) {
+                        last = x;
+                        return -1;
+                    });
+            if (last == nullptr)
+            {
+                throw std::logic_error("min() on empty tree");
+            }
+            if (!last->deleting.load())
+            {
+                return last->key;
+            }
+            std::this_thread::yield(); // il sera bientôt détaché
+        }
+    }
+
+    size_t size() const
+    {
+        EpochDomain::Guard guard(domain);
+        return count(_head.left.load());
+    }
+
+private:
+    static int compare(const_reference a, const_reference b)
+    {
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+
+    static size_t count(const Node *x) noexcept
+    {
+        return x ? x->count.load(std::memory_order_relaxed) : 0;
+    }
+
+    // contribution de x à sa propre taille, 0 si son insertion n'est pas
+    // encore comptée jusqu'à lui. x doit être verrouillé.
+    static size_t own(const Node *x) noexcept
+    {
+        return count(x) - count(x->left.load()) - count(x->right.load());
+    }
+
+    static uint32_t randomPriority() noexcept
+    {
+        static thread_local uint64_t s =
+                std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        return uint32_t(s >> 32);
+    }
+
+    // enfant de p du côté de key, la tête n'ayant que la racine à gauche
+    std::atomic<Node *> &child(Link *p, const_reference key) noexcept
+    {
+        return p == &_head || key < static_cast<Node *>(p)->key ? p->left : p->right;
+    }
+
+    // noeuds verrouillés par une restructuration, réutilisés d'une
+    // écriture à l'autre du même thread
+    static std::vector<Moved> &movedNodes()
+    {
+        static thread_local std::vector<Moved> moved;
+        moved.clear();
+        return moved;
+    }
+
+    static void beginWrite(Link *x) noexcept
+    {
+        x->version.fetch_add(1);
+    }
+
+    static void endWrite(Link *x) noexcept
+    {
+        x->version.fetch_add(1);
+    }
+
+    // version paire de x, attendue si une écriture le modifie
+    static uint64_t stableVersion(const Link *x) noexcept
+    {
+        for (;;)
+        {
+            uint64_t v = x->version.load();
+            if ((v & 1) == 0)
+            {
+                return v;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Descente sans verrou. Chaque noeud est lu entre deux lectures
+     *        identiques de sa version, et son parent est revalidé après la
+     *        lecture de la sienne : le noeud est alors encore son enfant
+     *        et son sous-arbre couvre bien l'intervalle attendu.
+     *
+     * @param restart: Remet à zéro l'état de step au début de chaque tentative
+     * @param step: Renvoie -1 ou 1 pour descendre à gauche ou à droite, 0
+     *              pour s'arrêter sur le noeud
+     *
+     * @return Le noeud où step s'est arrêté, nullptr si la descente est
+     *         sortie de l'arbre
+     *
+     * @remark Une section d'époque doit être ouverte par l'appelant
+     */
+    template <typename Restart, typename Step>
+    const Node *descend(Restart restart, Step step) const
+    {
+        for (;;)
+        {
+            restart();
+            const Link *p = &_head;
+            uint64_t vp = stableVersion(p);
+            const Node *x = _head.left.load();
+            for (;;)
+            {
+                uint64_t vx = x ? stableVersion(x) : 0;
+                if (p->version.load() != vp)
+                {
+                    break;
+                }
+                if (x == nullptr)
+                {
+                    return nullptr;
+                }
+                int dir = step(x);
+                if (dir == 0)
+                {
+                    if (x->version.load() != vx)
+                    {
+                        break;
+                    }
+                    return x;
+                }
+                p = x;
+                vp = vx;
+                x = dir < 0 ? x->left.load() : x->right.load();
+            }
+        }
+    }
+
+    // noeud de la clef, nullptr si elle est absente ou en cours de suppression
+    const Node *find(const_reference key) const
+    {
+        const Node *x = descend([] {}, [&key](const Node *x) { return compare(key, x->key); });
+        return x && !x->deleting.load() ? x : nullptr;
+    }
+
+    static void unlockAll(std::vector<Moved> &moved) noexcept
+    {
+        for (Moved &m : moved)
+        {
+            m.node->lock.unlock();
+        }
+    }
+
+    /**
+     * @brief Attache n sous le premier noeud de sa descente de priorité
+     *        supérieure ou égale à la sienne. Le sous-arbre qu'il remplace
+     *        est coupé selon sa clef en ses deux sous-arbres.
+     *
+     *        Seuls le parent de n et les noeuds coupés, ceux de la descente
+     *        de n sous lui, restent verrouillés jusqu'à la fin.
+     */
+    Placement place(Node *n)
+    {
+        const_reference key = n->key;
+        Link *p = &_head;
+        p->lock.lock();
+        Node *x = child(p, key).load();
+        while (x && x->priority >= n->priority)
+        {
+            if (compare(key, x->key) == 0)
+            {
+                bool busy = x->deleting.load();
+                p->lock.unlock();
+                return busy ? Placement::Busy : Placement::Present;
+            }
+            x->lock.lock();
+            p->lock.unlock();
+            p = x;
+            x = child(p, key).load();
+        }
+
+        std::vector<Moved> &moved = movedNodes();
+        try
+        {
+            for (Node *y = x; y; y = child(y, key).load())
+            {
+                y->lock.lock();
+                moved.push_back({y, 0});
+                if (compare(key, y->key) == 0)
+                {
+                    bool busy = y->deleting.load();
+                    unlockAll(moved);
+                    p->lock.unlock();
+                    return busy ? Placement::Busy : Placement::Present;
+                }
+                moved.back().own = own(y);
+            }
+        }
+        catch (...)
+        {
+            unlockAll(moved);
+            p->lock.unlock();
+            throw;
+        }
+
+        beginWrite(p);
+        for (Moved &m : moved)
+        {
+            beginWrite(m.node);
+        }
+        std::atomic<Node *> *l = &n->left, *r = &n->right;
+        for (Moved &m : moved)
+        {
+            if (m.node->key < key)
+            {
+                l->store(m.node);
+                l = &m.node->right;
+            }
+            else
+            {
+                r->store(m.node);
+                r = &m.node->left;
+            }
+        }
+        l->store(nullptr);
+        r->store(nullptr);
+        for (auto m = moved.rbegin(); m != moved.rend(); ++m)
+        {
+            m->node->count.store(m->own + count(m->node->left.load()) + count(m->node->right.load()));
+        }
+        n->count.store(count(n->left.load()) + count(n->right.load()));
+        child(p, key).store(n);
+
+        for (Moved &m : moved)
+        {
+            endWrite(m.node);
+            m.node->lock.unlock();
+        }
+        endWrite(p);
+        p->lock.unlock();
+        return Placement::Linked;
+    }
+
+    /**
+     * @brief Ajoute 1 à la taille de chaque noeud de la descente vers n,
+     *        n compris, en verrouillant chaque noeud avant de relâcher son
+     *        parent. Les tailles sont modifiées parent verrouillé : un
+     *        thread qui tient un noeud voit donc ses enfants comptés par
+     *        les mêmes écritures que lui.
+     */
+    void countInsertion(Node *n)
+    {
+        Link *p = &_head;
+        p->lock.lock();
+        for (;;)
+        {
+            Node *x = child(p, n->key).load();
+            x->lock.lock();
+            x->count.fetch_add(1, std::memory_order_relaxed);
+            p->lock.unlock();
+            if (x == n)
+            {
+                n->counted.store(true);
+                n->lock.unlock();
+                return;
+            }
+            p = x;
+        }
+    }
+
+    /**
+     * @brief Retire 1 à la taille de chaque ancêtre de d, comme
+     *        countInsertion, puis remplace d par la fusion de ses deux
+     *        sous-arbres. Le parent de d et d restent verrouillés jusqu'à
+     *        la fin, les noeuds de la fusion le temps de leur déplacement.
+     */
+    void unlink(Node *d)
+    {
+        const_reference key = d->key;
+        Link *p = &_head;
+        p->lock.lock();
+        for (Node *x; (x = child(p, key).load()) != d; p = x)
+        {
+            x->lock.lock();
+            x->count.fetch_sub(1, std::memory_order_relaxed);
+            p->lock.unlock();
+        }
+        d->lock.lock();
+        beginWrite(p);
+        beginWrite(d);
+
+        // fusion : le plus prioritaire des deux sous-arbres restants prend
+        // la place libérée, son sous-arbre sera exactement ce qui reste
+        Link *owner = p;
+        std::atomic<Node *> *hole = &child(p, key);
+        Node *a = d->left.load(), *b = d->right.load();
+        while (a && b)
+        {
+            Node *y = a->priority > b->priority ? a : b;
+            y->lock.lock();
+            beginWrite(y);
+            y->count.store(count(a) + count(b));
+            hole->store(y);
+            if (owner != p)
+            {
+                endWrite(owner);
+                owner->lock.unlock();
+            }
+            owner = y;
+            if (y == a)
+            {
+                hole = &a->right;
+                a = a->right.load();
+            }
+            else
+            {
+                hole = &b->left;
+                b = b->left.load();
+            }
+        }
+        hole->store(a ? a : b);
+        if (owner != p)
+        {
+            endWrite(owner);
+            owner->lock.unlock();
+        }
+
+        endWrite(d);
+        d->lock.unlock();
+        endWrite(p);
+        p->lock.unlock();
+    }
+};
+
+#endif
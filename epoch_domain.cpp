@@ -0,0 +1,248 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : epoch_domain.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Récupération de mémoire par époques, pour les structures lues
+               sans verrou.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Un objet retiré à l'époque e n'est plus accessible aux
+               lecteurs entrés après son retrait. Il est détruit quand
+               l'époque globale atteint e + 2 : tout lecteur qui aurait pu
+               l'atteindre est alors sorti de sa section.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef EPOCH_DOMAIN_CPP
+#define EPOCH_DOMAIN_CPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ *  @brief Domaine de récupération par époques, partagé par tout le programme.
+ *
+ *  Un lecteur protège ses accès par un EpochDomain::Guard. Un écrivain qui
+ *  a rendu un objet inaccessible le confie à retire() au lieu de le
+ *  détruire, il sera détruit quand plus aucun lecteur ne pourra l'utiliser.
+ */
+class EpochDomain
+{
+public:
+    /**
+     *  @brief Base des objets confiés à retire(), chainés sans allocation
+     */
+    class Retired
+    {
+        friend class EpochDomain;
+        Retired *next = nullptr;
+        uint64_t epoch = 0; // époque du retrait
+
+    public:
+        virtual ~Retired()
+        {
+        }
+    };
+
+private:
+    // état d'un thread, jamais libéré avant le domaine mais réutilisé
+    struct Record
+    {
+        std::atomic<uint64_t> state; // (époque << 1) | 1 en section, 0 sinon
+        std::atomic<bool> used;      // attribué à un thread vivant
+        Record *next;
+        unsigned depth;              // sections imbriquées du thread
+
+        Record() : state(0), used(true), next(nullptr), depth(0)
+        {
+        }
+    };
+
+    std::atomic<uint64_t> epoch;
+    std::atomic<Record *> records;
+    std::mutex limboMutex;
+    Retired *limbo;      // objets retirés, du plus récent au plus ancien
+    size_t limboSize;
+
+    EpochDomain() : epoch(1), records(nullptr), limbo(nullptr), limboSize(0)
+    {
+    }
+
+public:
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    /**
+     * @brief Détruit les objets encore retirés. Plus aucun thread ne doit
+     *        être en section.
+     */
+    ~EpochDomain()
+    {
+        destroy(limbo);
+        for (Record *r = records.load(); r;)
+        {
+            Record *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    static EpochDomain &instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    /**
+     *  @brief Section de lecture : les objets retirés pendant sa durée, ou
+     *         accessibles à son début, ne sont pas détruits avant sa fin.
+     *         Les sections d'un même thread peuvent s'imbriquer.
+     */
+    class Guard
+    {
+        Record *r;
+
+    public:
+        explicit Guard(EpochDomain &d = EpochDomain::instance()) : r(d.self())
+        {
+            if (r->depth++ == 0)
+            {
+                r->state.store((d.epoch.load() << 1) | 1);
+            }
+        }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard()
+        {
+            if (--r->depth == 0)
+            {
+                r->state.store(0, std::memory_order_release);
+            }
+        }
+    };
+
+    /**
+     * @brief Confie un objet devenu inaccessible, détruit par delete quand
+     *        aucune section en cours ne peut plus l'atteindre
+     *
+     * @remark Complexité O(1) amorti, O(T + L) lors d'une collecte avec T
+     *         threads et L objets en attente
+     */
+    void retire(Retired *p) noexcept
+    {
+        Retired *ready = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(limboMutex);
+            p->epoch = epoch.load();
+            p->next = limbo;
+            limbo = p;
+            if (++limboSize >= 64)
+            {
+                ready = collect();
+            }
+        }
+        destroy(ready);
+    }
+
+private:
+    /**
+     * @brief Avance l'époque si possible et détache les objets retirés
+     *        depuis au moins deux époques. limboMutex doit être verrouillé.
+     */
+    Retired *collect() noexcept
+    {
+        uint64_t e = epoch.load();
+        bool quiet = true;
+        for (Record *r = records.load(); r; r = r->next)
+        {
+            uint64_t s = r->state.load();
+            if ((s & 1) && (s >> 1) != e)
+            {
+                quiet = false;
+                break;
+            }
+        }
+        if (quiet)
+        {
+            epoch.compare_exchange_strong(e, e + 1);
+            e = epoch.load();
+        }
+
+        Retired *ready = nullptr;
+        for (Retired **p = &limbo; *p;)
+        {
+            if ((*p)->epoch + 2 <= e)
+            {
+                Retired *q = *p;
+                *p = q->next;
+                q->next = ready;
+                ready = q;
+                --limboSize;
+            }
+            else
+            {
+                p = &(*p)->next;
+            }
+        }
+        return ready;
+    }
+
+    static void destroy(Retired *p) noexcept
+    {
+        while (p)
+        {
+            Retired *next = p->next;
+            delete p;
+            p = next;
+        }
+    }
+
+    // enregistrement du thread courant, rendu à la fin du thread
+    Record *self()
+    {
+        struct Owner
+        {
+            Record *r = nullptr;
+
+            ~Owner()
+            {
+                if (r)
+                {
+                    r->used.store(false, std::memory_order_release);
+                }
+            }
+        };
+        static thread_local Owner owner;
+        if (owner.r == nullptr)
+        {
+            owner.r = acquire();
+        }
+        return owner.r;
+    }
+
+    Record *acquire()
+    {
+        for (Record *r = records.load(); r; r = r->next)
+        {
+            bool free = false;
+            if (!r->used.load() && r->used.compare_exchange_strong(free, true))
+            {
+                return r;
+            }
+        }
+        Record *r = new Record;
+        Record *head = records.load();
+        do
+        {
+            r->next = head;
+        } while (!records.compare_exchange_weak(head, r));
+        return r;
+    }
+};
+
+#endif
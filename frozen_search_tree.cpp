@@ -0,0 +1,325 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : frozen_search_tree.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Image figée, en lecture seule, d'un arbre binaire de recherche,
+               rangée dans un tableau contigu selon l'ordre d'Eytzinger.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Le noeud d'indice k (à partir de 1) a pour enfants 2k et 2k+1.
+               Les premiers niveaux, parcourus par toutes les recherches,
+               occupent quelques lignes de cache au début du tableau et les
+               descendants d'un noeud sur 4 niveaux sont contigus, ce qui
+               permet de les précharger.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef FROZEN_SEARCH_TREE_CPP
+#define FROZEN_SEARCH_TREE_CPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ *  @brief Ensemble trié immuable, stocké dans l'ordre d'Eytzinger (parcours
+ *         en largeur d'un arbre binaire complet).
+ *
+ *  Les recherches descendent l'arbre implicite sans branchement dépendant
+ *  des clefs : l'indice suivant est 2k + (clef < cherchée). Le rang de
+ *  chaque case est conservé dans un tableau parallèle aux clefs.
+ *
+ *  @tparam T: type des clefs
+ *  @tparam Compare: ordre strict des clefs, objet fonction sans état,
+ *                   celui de l'arbre dont l'ensemble est l'image
+ */
+template <typename T, typename Compare = std::less<T>>
+class FrozenSearchTree
+{
+public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using const_pointer = const T *;
+
+private:
+    std::vector<T> keys;       // keys[k-1] : clef de la case k
+    std::vector<size_t> ranks; // ranks[k-1] : rang de la clef de la case k
+    std::vector<size_t> slots; // slots[i] : case de la clef de rang i
+
+public:
+    /**
+     * @brief Construit un ensemble vide
+     */
+    FrozenSearchTree() noexcept
+    {
+    }
+
+    /**
+     * @brief Construit l'ensemble des clefs données
+     *
+     * @param sorted: Les clefs. Déjà triées sans doublon (cas de freeze()),
+     *                elles ne sont que déplacées, sinon elles sont d'abord
+     *                triées et dédoublonnées.
+     *
+     * @remark Complexité O(N), O(N log(N)) si les clefs ne sont pas triées
+     */
+    explicit FrozenSearchTree(std::vector<T> sorted)
+    {
+        if (!isStrictlyIncreasing(sorted))
+        {
+            std::sort(sorted.begin(), sorted.end(), Compare());
+            sorted.erase(std::unique(sorted.begin(), sorted.end(), equivalent),
+                         sorted.end());
+        }
+        const size_t n = sorted.size();
+        ranks.resize(n);
+        slots.resize(n);
+
+        // parcours symétrique de l'arbre implicite : la i-ème case visitée
+        // reçoit la clef de rang i
+        size_t k = leftmost(1, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            ranks[k - 1] = i;
+            slots[i] = k;
+            if (2 * k + 1 <= n)
+            {
+                k = leftmost(2 * k + 1, n);
+            }
+            else
+            {
+                // remonte tant que k est un enfant droit
+                k >>= trailingOnes(k) + 1;
+            }
+        }
+
+        keys.reserve(n);
+        for (size_t s = 0; s < n; ++s)
+        {
+            keys.push_back(std::move(sorted[ranks[s]]));
+        }
+    }
+
+    /**
+     * @brief Construit l'ensemble des clefs de [first, last[
+     *
+     * @remark Complexité O(N), O(N log(N)) si les clefs ne sont pas triées
+     */
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    FrozenSearchTree(InputIt first, InputIt last)
+            : FrozenSearchTree(std::vector<T>(first, last))
+    {
+    }
+
+    size_t size() const noexcept
+    {
+        return keys.size();
+    }
+
+    /**
+     * @brief Recherche d'une clef
+     *
+     * @remark Complexité O(log(N))
+     */
+    bool contains(const_reference key) const
+    {
+        size_t k = lowerSlot(key);
+        return k != 0 && !less(key, keys[k - 1]);
+    }
+
+    /**
+     * @brief Recherche d'un lot de clefs
+     *
+     * Les recherches sont menées par groupes de Lanes, niveau par niveau :
+     * les accès mémoire d'un même niveau sont indépendants et se recouvrent
+     * au lieu de s'attendre les uns les autres. Pour les types arithmétiques
+     * la boucle sur les recherches d'un groupe est vectorisable.
+     *
+     * @param first, last: Clefs cherchées
+     * @param out: Reçoit, dans l'ordre, un bool par clef cherchée
+     *
+     * @return out après la dernière écriture
+     *
+     * @remark Complexité O(M log(N)) pour M clefs
+     */
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt contains(ForwardIt first, ForwardIt last, OutputIt out) const
+    {
+        const size_t n = keys.size();
+        ForwardIt query[Lanes];
+        size_t k[Lanes];
+        while (first != last)
+        {
+            size_t m = 0;
+            for (; m < Lanes && first != last; ++m, ++first)
+            {
+                query[m] = first;
+                k[m] = 1;
+            }
+            for (bool more = n != 0; more;)
+            {
+                more = false;
+                for (size_t i = 0; i < m; ++i)
+                {
+                    if (k[i] <= n)
+                    {
+                        k[i] = 2 * k[i] + less(keys[k[i] - 1], *query[i]);
+                        more = true;
+                    }
+                }
+            }
+            for (size_t i = 0; i < m; ++i)
+            {
+                size_t s = k[i] >> (trailingOnes(k[i]) + 1);
+                *out = s != 0 && !less(*query[i], keys[s - 1]);
+                ++out;
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Première clef qui n'est pas inférieure à key
+     *
+     * @return Pointeur sur la plus petite clef >= key, nullptr s'il n'y en a pas
+     *
+     * @remark Complexité O(log(N))
+     */
+    const_pointer lower_bound(const_reference key) const
+    {
+        size_t k = lowerSlot(key);
+        return k ? &keys[k - 1] : nullptr;
+    }
+
+    /**
+     * @brief Nombre de clefs strictement inférieures à key
+     *
+     * @remark Complexité O(log(N))
+     */
+    size_t count_less(const_reference key) const
+    {
+        size_t k = lowerSlot(key);
+        return k ? ranks[k - 1] : keys.size();
+    }
+
+    /**
+     * @brief Position d'une clef dans l'ordre croissant des éléments
+     *
+     * @return La position entre 0 et size()-1, size_t(-1) si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    size_t rank(const_reference key) const
+    {
+        size_t k = lowerSlot(key);
+        return k != 0 && !less(key, keys[k - 1]) ? ranks[k - 1] : size_t(-1);
+    }
+
+    /**
+     * @brief Cherche la clef en position n
+     *
+     * @exception std::out_of_range si n >= size()
+     *
+     * @remark Complexité O(1)
+     */
+    const_reference nth_element(size_t n) const
+    {
+        if (n >= keys.size())
+        {
+            throw std::out_of_range("L'arbre ne contient pas autant d'elements");
+        }
+        return keys[slots[n] - 1];
+    }
+
+private:
+    // nombre de recherches menées de front par contains(first, last, out)
+    static const size_t Lanes = 8;
+
+    /**
+     * @brief Case de la plus petite clef >= key, 0 s'il n'y en a pas
+     *
+     * La descente va jusqu'à sortir du tableau. Chaque pas à droite ajoute
+     * un 1 à la fin de k, la dernière descente à gauche est donc celle d'où
+     * partent les derniers 1 : on les retire avec le 0 qui les précède.
+     */
+    size_t lowerSlot(const_reference key) const
+    {
+        const size_t n = keys.size();
+        const T *data = keys.data();
+        size_t k = 1;
+        while (k <= n)
+        {
+#if defined(__GNUC__)
+            // les 16 arrière-petits-petits-enfants de k sont contigus
+            if (16 * k <= n)
+            {
+                __builtin_prefetch(data + 16 * k - 1);
+            }
+#endif
+            k = 2 * k + less(data[k - 1], key);
+        }
+        return k >> (trailingOnes(k) + 1);
+    }
+
+    // nombre de bits à 1 consécutifs à la fin de k
+    static unsigned trailingOnes(size_t k) noexcept
+    {
+#if defined(__GNUC__)
+        return ~k ? unsigned(__builtin_ctzll((unsigned long long)~k)) : unsigned(sizeof(size_t) * 8);
+#else
+        unsigned c = 0;
+        for (; k & 1; k >>= 1)
+        {
+            ++c;
+        }
+        return c;
+#endif
+    }
+
+    // case la plus à gauche du sous-arbre de la case k
+    static size_t leftmost(size_t k, size_t n) noexcept
+    {
+        while (2 * k <= n)
+        {
+            k *= 2;
+        }
+        return k;
+    }
+
+    // a < b selon Compare
+    template <typename A, typename B>
+    static bool less(const A &a, const B &b)
+    {
+        return Compare()(a, b);
+    }
+
+    static bool equivalent(const T &a, const T &b)
+    {
+        return !less(a, b) && !less(b, a);
+    }
+
+    static bool isStrictlyIncreasing(const std::vector<T> &v)
+    {
+        for (size_t i = 1; i < v.size(); ++i)
+        {
+            if (!less(v[i - 1], v[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <typename T, typename Compare>
+const size_t FrozenSearchTree<T, Compare>::Lanes;
+
+#endif
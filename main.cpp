@@ -4,7 +4,7 @@
 
 #include <iostream>
 #include <algorithm>
-#include "abr.cpp"
+#include "binary_search_tree.cpp"
 using namespace std;
 
 
@@ -52,6 +52,9 @@ ostream& operator<< ( ostream& os, const Int& i ) {
 
 int Int::timeBomb = 0;
 
+// arbre traçant les constructions et destructions de noeuds sur cout
+using ABR = BinarySearchTree<Int, NoBalance, std::allocator<Int>, StreamTrace>;
+
 void visitor(const Int& a) { cout << a << " "; }
 
 int main() {
@@ -60,7 +63,7 @@ int main() {
 
     vector<int> values = { 10, 12, 16, 15, 7, 1, 12, 5, 11, 11, 4, 2, 6, 0, 13 };
 
-    BinarySearchTree<Int> abr;
+    ABR abr;
 
     // **** INSERT ****
 
@@ -156,7 +159,7 @@ int main() {
 
     cout << "Test du move constructor - abr2(move(abr)) \n";
     {
-      BinarySearchTree<Int> abr2 ( move(abr) );
+      ABR abr2 ( move(abr) );
       cout << "abr2: "; abr2.display();
       cout << "\n";
       cout << "abr: "; abr.display();
@@ -164,14 +167,14 @@ int main() {
 
       {
         cout << "Test du copy constructor - abr3(abr2)\n";
-        BinarySearchTree<Int> abr3 ( abr2 );
+        ABR abr3 ( abr2 );
         cout << "\n";
         cout << "abr3: "; abr3.display();
         cout << "\n";
 
         {
           cout << "Test du move operator= - abr4 = move(abr2)\n";
-          BinarySearchTree<Int> abr4;
+          ABR abr4;
           abr4 = move(abr2);
           cout << "abr4: "; abr4.display();
           cout << "\n";
@@ -226,7 +229,7 @@ int main() {
     try {
       Int::timeBomb = -9;
       cout << "Test de copie par constructeur manquee \n";
-      BinarySearchTree<Int> abr2(abr);
+      ABR abr2(abr);
     } catch (...) {
       cout << "\nException capturée \n\n";
     }
@@ -234,7 +237,7 @@ int main() {
 
     {
       cout << "Creation abr2 \n";
-      BinarySearchTree<Int> abr2;
+      ABR abr2;
       for(int i : { 3, 7, 4, 1, 2 } )
         abr2.insert(i);
 
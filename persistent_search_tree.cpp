@@ -0,0 +1,617 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : persistent_search_tree.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Arbre binaire de recherche persistant : les noeuds sont
+               immuables et partagés entre les versions de l'arbre.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Dans les complexités, N fait référence au nombre de noeuds
+               présents dans l'arbre. Une modification recopie le chemin de
+               la racine au noeud modifié, le reste de l'arbre est partagé
+               avec l'ancienne version.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef PERSISTENT_SEARCH_TREE_CPP
+#define PERSISTENT_SEARCH_TREE_CPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ *  @brief Arbre AVL persistant, de même interface que BinarySearchTree.
+ *
+ *  Les noeuds ne sont jamais modifiés après leur création et comptent les
+ *  références qui les désignent. La copie et snapshot() sont donc en O(1) ;
+ *  insert et deleteElement recopient les O(log(N)) noeuds du chemin qu'ils
+ *  parcourent et n'affectent pas les autres versions. Un noeud est libéré
+ *  avec la dernière version qui l'utilise.
+ *
+ *  C'est une classe distincte de BinarySearchTree, dont la copie reste en
+ *  O(N) : ses noeuds sont modifiés sur place et ne peuvent être partagés.
+ *  L'équilibrage est toujours AVL, les noeuds sont alloués par new et ne
+ *  sont pas tracés : les politiques Balance, Allocator et Tracer de
+ *  BinarySearchTree ne s'appliquent pas ici.
+ *
+ *  Deux versions distinctes peuvent être utilisées simultanément depuis
+ *  des threads différents, même si elles partagent des noeuds.
+ *
+ *  @tparam T: type des clefs
+ *  @tparam Compare: ordre strict des clefs, objet fonction sans état
+ *                   construit par défaut à chaque comparaison
+ */
+template <typename T, typename Compare = std::less<T>>
+class PersistentSearchTree
+{
+public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using key_compare = Compare;
+
+private:
+    struct Node;
+
+    /**
+     *  @brief Référence comptée vers un noeud, nullptr pour un arbre vide
+     */
+    class Ref
+    {
+        const Node *p;
+
+    public:
+        Ref() noexcept : p(nullptr)
+        {
+        }
+
+        // prend possession d'une référence déjà comptée
+        explicit Ref(const Node *p) noexcept : p(p)
+        {
+        }
+
+        Ref(const Ref &other) noexcept : p(other.p)
+        {
+            if (p)
+            {
+                p->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Ref(Ref &&other) noexcept : p(other.p)
+        {
+            other.p = nullptr;
+        }
+
+        Ref &operator=(Ref other) noexcept
+        {
+            std::swap(p, other.p);
+            return *this;
+        }
+
+        ~Ref()
+        {
+            if (p && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete p;
+            }
+        }
+
+        const Node *get() const noexcept
+        {
+            return p;
+        }
+
+        const Node *operator->() const noexcept
+        {
+            return p;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return p != nullptr;
+        }
+    };
+
+    /**
+     *  @brief Noeud immuable, hormis son compteur de références
+     */
+    struct Node
+    {
+        const value_type key;
+        const Ref left;
+        const Ref right;
+        const size_t nbElements;
+        const int height;
+        mutable std::atomic<size_t> refs;
+
+        Node(const_reference key, Ref l, Ref r)
+                : key(key), left(std::move(l)), right(std::move(r)),
+                  nbElements(size(left) + size(right) + 1),
+                  height(std::max(PersistentSearchTree::height(left),
+                                  PersistentSearchTree::height(right)) + 1),
+                  refs(1)
+        {
+        }
+
+        Node(const Node &) = delete;
+        Node &operator=(const Node &) = delete;
+    };
+
+    Ref _root;
+
+public:
+    /**
+     *  @brief Constructeur par défaut. Construit un arbre vide
+     */
+    PersistentSearchTree() noexcept
+    {
+    }
+
+    /**
+     *  @brief Constucteur de copie. Les deux arbres partagent leurs noeuds.
+     *
+     *  @remark Complexité : O(1)
+     */
+    PersistentSearchTree(const PersistentSearchTree &other) noexcept = default;
+
+    PersistentSearchTree(PersistentSearchTree &&other) noexcept = default;
+
+    /**
+     *  @brief Affectation. L'ancienne version libère les noeuds qu'elle
+     *         était seule à utiliser.
+     *
+     *  @remark Complexité : O(1), plus la libération des noeuds non partagés
+     */
+    PersistentSearchTree &operator=(const PersistentSearchTree &other) noexcept = default;
+
+    PersistentSearchTree &operator=(PersistentSearchTree &&other) noexcept = default;
+
+    /**
+     *  @brief Version figée de l'arbre, que les modifications ultérieures de
+     *         celui-ci n'affectent pas
+     *
+     *  @remark Complexité : O(1)
+     */
+    PersistentSearchTree snapshot() const noexcept
+    {
+        return *this;
+    }
+
+    /**
+     *  @brief Echange le contenu avec un autre arbre
+     *
+     *  @remark Complexité : O(1)
+     */
+    void swap(PersistentSearchTree &other) noexcept
+    {
+        std::swap(_root, other._root);
+    }
+
+    /**
+     *  @brief Vide l'arbre
+     *
+     *  @remark Complexité : O(1), plus la libération des noeuds non partagés
+     */
+    void clear() noexcept
+    {
+        _root = Ref();
+    }
+
+    size_t size() const noexcept
+    {
+        return size(_root);
+    }
+
+    /**
+     * @brief Insertion d'une clef dans l'arbre
+     *
+     * @param key: la clef à insérer
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    void insert(const_reference key)
+    {
+        _root = insert(_root, key);
+    }
+
+    /**
+     * @brief Recherche d'une clef
+     *
+     * @return true si clef trouvée, false dans le cas contraire
+     *
+     * @remark Complexité O(log(N))
+     */
+    bool contains(const_reference key) const noexcept
+    {
+        const Node *r = _root.get();
+        while (r)
+        {
+            if (less(key, r->key))
+            {
+                r = r->left.get();
+            }
+            else if (less(r->key, key))
+            {
+                r = r->right.get();
+            }
+            else
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Recherche de la clef minimale
+     *
+     * @exception std::logic_error si l'arbre est vide
+     *
+     * @remark Complexité O(log(N))
+     */
+    const_reference min() const
+    {
+        const Node *r = _root.get();
+        if (r == nullptr)
+        {
+            throw std::logic_error("L'arbre est vide, il n'y a donc pas de minimum");
+        }
+        while (r->left)
+        {
+            r = r->left.get();
+        }
+        return r->key;
+    }
+
+    /**
+     * @brief Supprime le plus petit élément de l'arbre
+     *
+     * @exception std::logic_error si l'arbre est vide
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    void deleteMin()
+    {
+        if (!_root)
+        {
+            throw std::logic_error("Arbre vide il n'est pas possible de delete le min");
+        }
+        Ref min;
+        _root = detachMin(_root, min);
+    }
+
+    /**
+     * @brief Supprime l'élément de la clef de l'arbre
+     *
+     * @return true si la clef était présente
+     *
+     * @remark Complexité O(log(N)), garantie forte
+     */
+    bool deleteElement(const_reference key)
+    {
+        Ref r = deleteElement(_root, key);
+        if (r.get() == _root.get())
+        {
+            return false;
+        }
+        _root = std::move(r);
+        return true;
+    }
+
+    /**
+     * @brief Cherche la clef en position n
+     *
+     * @exception std::out_of_range si n >= size()
+     *
+     * @remark Complexité O(log(N))
+     */
+    const_reference nth_element(size_t n) const
+    {
+        if (n >= size())
+        {
+            throw std::out_of_range("L'arbre ne contient pas autant d'elements");
+        }
+        const Node *r = _root.get();
+        for (;;)
+        {
+            size_t nl = size(r->left);
+            if (n < nl)
+            {
+                r = r->left.get();
+            }
+            else if (n > nl)
+            {
+                n -= nl + 1;
+                r = r->right.get();
+            }
+            else
+            {
+                return r->key;
+            }
+        }
+    }
+
+    /**
+     * @brief Position d'une clef dans l'ordre croissant des éléments
+     *
+     * @return La position entre 0 et size()-1, size_t(-1) si la clef est absente
+     *
+     * @remark Complexité O(log(N))
+     */
+    size_t rank(const_reference key) const noexcept
+    {
+        size_t before = 0;
+        const Node *r = _root.get();
+        while (r)
+        {
+            if (less(key, r->key))
+            {
+                r = r->left.get();
+            }
+            else if (less(r->key, key))
+            {
+                before += size(r->left) + 1;
+                r = r->right.get();
+            }
+            else
+            {
+                return before + size(r->left);
+            }
+        }
+        return size_t(-1);
+    }
+
+    /**
+     * @brief Parcours pré-ordonné de l'arbre
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename Fn>
+    void visitPre(Fn f) const
+    {
+        visitPre(_root.get(), f);
+    }
+
+    /**
+     * @brief Parcours symétrique de l'arbre
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename Fn>
+    void visitSym(Fn f) const
+    {
+        visitSym(_root.get(), f);
+    }
+
+    /**
+     * @brief Parcours post-ordonné de l'arbre
+     *
+     * @remark Complexité O(N)
+     */
+    template <typename Fn>
+    void visitPost(Fn f) const
+    {
+        visitPost(_root.get(), f);
+    }
+
+private:
+    // les parcours sont itératifs, avec une pile de la hauteur de l'arbre :
+    // les noeuds, immuables, ne peuvent servir de liens de retour
+    template <typename Fn>
+    static void visitPre(const Node *r, Fn &f)
+    {
+        std::vector<const Node *> stack;
+        stack.reserve(size_t(height(r)));
+        if (r != nullptr)
+            stack.push_back(r);
+        while (!stack.empty())
+        {
+            r = stack.back();
+            stack.pop_back();
+            f(r->key);
+            if (r->right)
+                stack.push_back(r->right.get());
+            if (r->left)
+                stack.push_back(r->left.get());
+        }
+    }
+
+    template <typename Fn>
+    static void visitSym(const Node *r, Fn &f)
+    {
+        std::vector<const Node *> stack;
+        stack.reserve(size_t(height(r)));
+        while (r != nullptr || !stack.empty())
+        {
+            if (r != nullptr)
+            {
+                stack.push_back(r);
+                r = r->left.get();
+            }
+            else
+            {
+                r = stack.back();
+                stack.pop_back();
+                f(r->key);
+                r = r->right.get();
+            }
+        }
+    }
+
+    template <typename Fn>
+    static void visitPost(const Node *r, Fn &f)
+    {
+        std::vector<const Node *> stack;
+        stack.reserve(size_t(height(r)));
+        const Node *last = nullptr; // dernier noeud visité
+        while (r != nullptr || !stack.empty())
+        {
+            if (r != nullptr)
+            {
+                stack.push_back(r);
+                r = r->left.get();
+            }
+            else if (stack.back()->right && stack.back()->right.get() != last)
+            {
+                r = stack.back()->right.get();
+            }
+            else
+            {
+                last = stack.back();
+                stack.pop_back();
+                f(last->key);
+            }
+        }
+    }
+
+    // a < b selon Compare
+    static bool less(const_reference a, const_reference b)
+    {
+        return Compare()(a, b);
+    }
+
+    static size_t size(const Ref &r) noexcept
+    {
+        return r ? r->nbElements : 0;
+    }
+
+    static int height(const Ref &r) noexcept
+    {
+        return height(r.get());
+    }
+
+    static int height(const Node *r) noexcept
+    {
+        return r ? r->height : 0;
+    }
+
+    static Ref node(const_reference key, Ref l, Ref r)
+    {
+        return Ref(new Node(key, std::move(l), std::move(r)));
+    }
+
+    /**
+     * @brief Nouveau noeud de clef key et de sous-arbres l et r, dont les
+     *        hauteurs diffèrent au plus de 2, rééquilibré par une rotation
+     *        simple ou double. Seuls les noeuds déplacés sont recréés.
+     *
+     * @remark Complexité O(1)
+     */
+    static Ref balance(const_reference key, Ref l, Ref r)
+    {
+        int hl = height(l), hr = height(r);
+        if (hl > hr + 1)
+        {
+            if (height(l->left) >= height(l->right))
+            {
+                return node(l->key, l->left, node(key, l->right, std::move(r)));
+            }
+            const Ref &lr = l->right;
+            return node(lr->key, node(l->key, l->left, lr->left),
+                        node(key, lr->right, std::move(r)));
+        }
+        if (hr > hl + 1)
+        {
+            if (height(r->right) >= height(r->left))
+            {
+                return node(r->key, node(key, std::move(l), r->left), r->right);
+            }
+            const Ref &rl = r->left;
+            return node(rl->key, node(key, std::move(l), rl->left),
+                        node(r->key, rl->right, r->right));
+        }
+        return node(key, std::move(l), std::move(r));
+    }
+
+    /**
+     * @brief Insertion d'une clef dans un sous-arbre
+     *
+     * @return Le nouveau sous-arbre, r lui-même si key y était déjà
+     *
+     * @remark Complexité O(log(N))
+     */
+    static Ref insert(const Ref &r, const_reference key)
+    {
+        if (!r)
+        {
+            return node(key, Ref(), Ref());
+        }
+        if (less(key, r->key))
+        {
+            Ref l = insert(r->left, key);
+            return l.get() == r->left.get() ? r : balance(r->key, std::move(l), r->right);
+        }
+        if (less(r->key, key))
+        {
+            Ref g = insert(r->right, key);
+            return g.get() == r->right.get() ? r : balance(r->key, r->left, std::move(g));
+        }
+        return r;
+    }
+
+    /**
+     * @brief Retire le minimum d'un sous-arbre non vide
+     *
+     * @param min: Reçoit le noeud minimal
+     *
+     * @return Le nouveau sous-arbre
+     */
+    static Ref detachMin(const Ref &r, Ref &min)
+    {
+        if (!r->left)
+        {
+            min = r;
+            return r->right;
+        }
+        return balance(r->key, detachMin(r->left, min), r->right);
+    }
+
+    /**
+     * @brief Suppression d'une clef dans un sous-arbre
+     *
+     * @return Le nouveau sous-arbre, r lui-même si key n'y était pas
+     *
+     * @remark Complexité O(log(N))
+     */
+    static Ref deleteElement(const Ref &r, const_reference key)
+    {
+        if (!r)
+        {
+            return r;
+        }
+        if (less(key, r->key))
+        {
+            Ref l = deleteElement(r->left, key);
+            return l.get() == r->left.get() ? r : balance(r->key, std::move(l), r->right);
+        }
+        if (less(r->key, key))
+        {
+            Ref g = deleteElement(r->right, key);
+            return g.get() == r->right.get() ? r : balance(r->key, r->left, std::move(g));
+        }
+        if (!r->left)
+        {
+            return r->right;
+        }
+        if (!r->right)
+        {
+            return r->left;
+        }
+        // remplacée par son successeur
+        Ref min;
+        Ref g = detachMin(r->right, min);
+        return balance(min->key, r->left, std::move(g));
+    }
+};
+
+#endif
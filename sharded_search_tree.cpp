@@ -0,0 +1,310 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : sharded_search_tree.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Ensemble trié partagé entre threads, découpé par intervalles
+               de clefs en plusieurs BinarySearchTree indépendants.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Les bornes des intervalles sont choisies par nth_element pour
+               que les fragments aient la même taille, et choisies à nouveau
+               dès qu'un fragment devient trop gros.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef SHARDED_SEARCH_TREE_CPP
+#define SHARDED_SEARCH_TREE_CPP
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "binary_search_tree.cpp"
+
+/**
+ *  @brief Ensemble trié utilisable simultanément par plusieurs threads.
+ *
+ *  Les clefs sont réparties en K fragments par K-1 bornes croissantes : le
+ *  fragment i contient les clefs de [bounds[i-1], bounds[i][. Chaque
+ *  fragment est un BinarySearchTree protégé par son propre verrou, deux
+ *  écritures dans des fragments différents ne se gênent donc pas.
+ *
+ *  Les opérations globales (size, rank, nth_element) combinent les tailles
+ *  des fragments. Elles sont exactes quand aucune écriture n'est en cours,
+ *  et sinon reflètent un état où chaque fragment a été lu à un instant
+ *  différent.
+ */
+template <typename T, typename Balance = RedBlackBalance>
+class ShardedSearchTree
+{
+public:
+    using value_type = T;
+    using const_reference = const T &;
+    using Tree = BinarySearchTree<T, Balance>;
+
+private:
+    // fragment alloué séparément et complété d'une ligne de cache, pour
+    // que les verrous de deux fragments ne partagent pas la même ligne
+    struct Shard
+    {
+        std::mutex mutex;
+        Tree tree;
+        std::atomic<size_t> count; // tree.size(), lisible sans le verrou
+        char padding[64];
+
+        Shard() : count(0)
+        {
+        }
+    };
+
+    // les bornes sont lues en mode partagé par toutes les opérations et
+    // modifiées en mode exclusif par repartition()
+    mutable std::shared_timed_mutex partition;
+    std::vector<T> bounds;
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t minShard; // taille en dessous de laquelle on ne repartitionne pas
+
+public:
+    /**
+     * @brief Construit un ensemble vide
+     *
+     * @param k: Nombre de fragments, au moins 1
+     * @param minShard: Un fragment n'est jamais jugé trop gros en dessous
+     *                  de cette taille
+     */
+    explicit ShardedSearchTree(size_t k = 16, size_t minShard = 1024)
+            : minShard(minShard)
+    {
+        k = std::max<size_t>(k, 1);
+        for (size_t i = 0; i < k; ++i)
+        {
+            shards.emplace_back(new Shard);
+        }
+    }
+
+    ShardedSearchTree(const ShardedSearchTree &) = delete;
+    ShardedSearchTree &operator=(const ShardedSearchTree &) = delete;
+
+    /**
+     * @brief Insertion d'une clef. Si son fragment devient plus de deux fois
+     *        plus gros que la moyenne, les bornes sont choisies à nouveau.
+     *
+     * @remark Complexité O(log(N)), O(N) lors d'une répartition
+     */
+    void insert(const_reference key)
+    {
+        bool unbalanced;
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(partition);
+            Shard &s = shardOf(key);
+            std::lock_guard<std::mutex> guard(s.mutex);
+            s.tree.insert(key);
+            s.count.store(s.tree.size(), std::memory_order_relaxed);
+            unbalanced = tooLarge(s.tree.size());
+        }
+        if (unbalanced)
+        {
+            repartition(false);
+        }
+    }
+
+    /**
+     * @brief Supprime l'élément de la clef
+     *
+     * @return true si la clef était présente
+     *
+     * @remark Complexité O(log(N))
+     */
+    bool deleteElement(const_reference key)
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(partition);
+        Shard &s = shardOf(key);
+        std::lock_guard<std::mutex> guard(s.mutex);
+        bool found = s.tree.deleteElement(key);
+        s.count.store(s.tree.size(), std::memory_order_relaxed);
+        return found;
+    }
+
+    /**
+     * @brief Recherche d'une clef
+     *
+     * @remark Complexité O(log(N))
+     */
+    bool contains(const_reference key) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(partition);
+        Shard &s = shardOf(key);
+        std::lock_guard<std::mutex> guard(s.mutex);
+        return s.tree.contains(key);
+    }
+
+    /**
+     * @brief Nombre total de clefs
+     *
+     * @remark Complexité O(K)
+     */
+    size_t size() const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(partition);
+        return countBefore(shards.size());
+    }
+
+    /**
+     * @brief Position d'une clef dans l'ordre croissant de toutes les clefs
+     *
+     * @return La position entre 0 et size()-1, size_t(-1) si la clef est absente
+     *
+     * @remark Complexité O(K + log(N))
+     */
+    size_t rank(const_reference key) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(partition);
+        size_t i = indexOf(key);
+        size_t r;
+        {
+            std::lock_guard<std::mutex> guard(shards[i]->mutex);
+            r = shards[i]->tree.rank(key);
+        }
+        return r == size_t(-1) ? r : countBefore(i) + r;
+    }
+
+    /**
+     * @brief Copie de la clef en position n dans l'ordre croissant de toutes
+     *        les clefs
+     *
+     * @exception std::out_of_range si n >= size()
+     *
+     * @remark Complexité O(K + log(N))
+     */
+    value_type nth_element(size_t n) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(partition);
+        for (const std::unique_ptr<Shard> &s : shards)
+        {
+            std::lock_guard<std::mutex> guard(s->mutex);
+            if (n < s->tree.size())
+            {
+                return s->tree.nth_element(n);
+            }
+            n -= s->tree.size();
+        }
+        throw std::out_of_range("L'arbre ne contient pas autant d'elements");
+    }
+
+    /**
+     * @brief Choisit de nouvelles bornes qui répartissent les clefs en
+     *        fragments de même taille, à une clef près
+     *
+     * @remark Complexité O(N + K log(N)), toutes les autres opérations
+     *         attendent sa fin
+     */
+    void rebalance()
+    {
+        repartition(true);
+    }
+
+private:
+    size_t indexOf(const_reference key) const
+    {
+        return size_t(std::upper_bound(bounds.begin(), bounds.end(), key) - bounds.begin());
+    }
+
+    Shard &shardOf(const_reference key) const
+    {
+        return *shards[indexOf(key)];
+    }
+
+    // somme des tailles des i premiers fragments
+    size_t countBefore(size_t i) const noexcept
+    {
+        size_t n = 0;
+        for (size_t j = 0; j < i; ++j)
+        {
+            n += shards[j]->count.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    bool tooLarge(size_t n) const noexcept
+    {
+        return n > minShard && n > 2 * countBefore(shards.size()) / shards.size();
+    }
+
+    /**
+     * @brief Nouvelles bornes : la clef de rang j*N/K est la borne inférieure
+     *        du fragment j. Les fragments sont reconstruits à partir de leurs
+     *        clefs triées par le constructeur par intervalle, en O(N).
+     *
+     * @param force: Si false, ne fait rien si plus aucun fragment n'est
+     *               trop gros, un autre thread ayant pu repartitionner
+     *
+     * @remark Garantie forte : les nouveaux fragments sont construits avant
+     *         de remplacer les anciens
+     */
+    void repartition(bool force)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(partition);
+        const size_t k = shards.size();
+        if (!force)
+        {
+            bool unbalanced = false;
+            for (const std::unique_ptr<Shard> &s : shards)
+            {
+                unbalanced = unbalanced || tooLarge(s->tree.size());
+            }
+            if (!unbalanced)
+            {
+                return;
+            }
+        }
+        const size_t total = countBefore(k);
+
+        // bornes choisies par nth_element global : fragment puis rang local
+        std::vector<T> next;
+        next.reserve(k - 1);
+        for (size_t j = 1; j < k && total >= k; ++j)
+        {
+            size_t n = j * total / k;
+            size_t i = 0;
+            while (n >= shards[i]->tree.size())
+            {
+                n -= shards[i]->tree.size();
+                ++i;
+            }
+            next.push_back(shards[i]->tree.nth_element(n));
+        }
+
+        // clefs triées de tous les fragments, découpées selon les bornes
+        std::vector<T> keys;
+        keys.reserve(total);
+        for (const std::unique_ptr<Shard> &s : shards)
+        {
+            keys.insert(keys.end(), s->tree.begin(), s->tree.end());
+        }
+        std::vector<Tree> trees;
+        trees.reserve(k);
+        typename std::vector<T>::const_iterator first = keys.begin();
+        for (size_t j = 0; j < k; ++j)
+        {
+            typename std::vector<T>::const_iterator last =
+                    j < next.size() ? std::lower_bound(first, keys.cend(), next[j]) : keys.cend();
+            trees.emplace_back(first, last);
+            first = last;
+        }
+
+        for (size_t j = 0; j < k; ++j)
+        {
+            shards[j]->tree.swap(trees[j]);
+            shards[j]->count.store(shards[j]->tree.size(), std::memory_order_relaxed);
+        }
+        bounds.swap(next);
+    }
+};
+
+#endif
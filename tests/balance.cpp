@@ -0,0 +1,135 @@
+//  Invariants des politiques d'équilibrage
+//
+//  Après chaque insertion ou suppression aléatoire, et après deleteMin,
+//  extract, split, join, erase_range et balance(), checkInvariants() doit
+//  confirmer l'ordre des clefs, les nbElements et les données propres à la
+//  politique : hauteurs et facteurs d'équilibre AVL, couleurs et hauteur
+//  noire rouge-noir, poids alpha du bouc émissaire. La hauteur mesurée par
+//  stats() doit rester sous la borne garantie par chaque politique.
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+// hauteur maximale d'un arbre de n clefs pour chaque politique
+static double bound(NoBalance, size_t n) {
+  return double(n);
+}
+
+static double bound(AvlBalance, size_t n) {
+  return 1.4405 * std::log2(double(n) + 2) - 0.3277;
+}
+
+static double bound(RedBlackBalance, size_t n) {
+  return 2 * std::log2(double(n) + 1);
+}
+
+// un arbre alpha-équilibré de n clefs a une hauteur d'au plus
+// log(n) / log(1/alpha) + 1, à deux noeuds près sous les sous-arbres de
+// trois clefs que le critère de poids laisse en chaîne
+static double bound(ScapegoatBalance<>, size_t n) {
+  return std::log(double(n) + 1) / std::log(4.0 / 3.0) + 2;
+}
+
+template <typename Balance, typename Tree>
+static void check(const Tree& t, const std::set<int>& ref) {
+  assert(t.checkInvariants());
+  assert(t.size() == ref.size());
+  assert(std::equal(t.begin(), t.end(), ref.begin(), ref.end()));
+  assert(double(t.stats().height) <= bound(Balance(), t.size()));
+}
+
+template <typename Balance>
+static void run(unsigned seed) {
+  typedef BinarySearchTree<int, Balance> Tree;
+  Tree t;
+  std::set<int> ref;
+  std::mt19937 g(seed);
+  check<Balance>(t, ref);
+
+  // clefs croissantes : les rotations se succèdent sur le bord droit
+  for (int i = 0; i < 500; ++i) {
+    t.insert(i);
+    ref.insert(i);
+    check<Balance>(t, ref);
+  }
+  for (int i = 0; i < 20000; ++i) {
+    int k = int(g() % 2000);
+    switch (g() % 5) {
+    case 0:
+    case 1:
+      t.insert(k);
+      ref.insert(k);
+      break;
+    case 2:
+    case 3:
+      assert(t.deleteElement(k) == (ref.erase(k) == 1));
+      break;
+    default:
+      if (!ref.empty()) {
+        t.deleteMin();
+        ref.erase(ref.begin());
+      }
+    }
+    if (i % 50 == 0) check<Balance>(t, ref);
+  }
+  check<Balance>(t, ref);
+
+  // un noeud extrait puis réinséré repasse par onUnlink et onInsert
+  for (int i = 0; i < 200 && !ref.empty(); ++i) {
+    int k = *std::next(ref.begin(), long(g() % ref.size()));
+    typename Tree::node_type n = t.extract(k);
+    assert(!n.empty());
+    ref.erase(k);
+    check<Balance>(t, ref);
+    assert(t.insert(std::move(n)));
+    ref.insert(k);
+  }
+  check<Balance>(t, ref);
+
+  std::pair<Tree, Tree> p = t.split(1000);
+  std::set<int> low(ref.begin(), ref.lower_bound(1000));
+  std::set<int> high(ref.lower_bound(1000), ref.end());
+  check<Balance>(p.first, low);
+  check<Balance>(p.second, high);
+  t = Tree::join(std::move(p.first), std::move(p.second));
+  check<Balance>(t, ref);
+
+  assert(t.erase_range(300, 1700) == size_t(std::distance(ref.lower_bound(300), ref.lower_bound(1700))));
+  ref.erase(ref.lower_bound(300), ref.lower_bound(1700));
+  check<Balance>(t, ref);
+
+  // des arbres de tailles très différentes réunis par join
+  Tree small;
+  for (int i = 0; i < 3; ++i) {
+    small.insert(5000 + i);
+    ref.insert(5000 + i);
+  }
+  t = Tree::join(std::move(t), std::move(small));
+  check<Balance>(t, ref);
+
+  t.balance();
+  check<Balance>(t, ref);
+  while (!ref.empty()) {
+    int k = *std::next(ref.begin(), long(g() % ref.size()));
+    assert(t.deleteElement(k));
+    ref.erase(k);
+    check<Balance>(t, ref);
+  }
+}
+
+int main() {
+  run<NoBalance>(1);
+  run<AvlBalance>(2);
+  run<RedBlackBalance>(3);
+  run<ScapegoatBalance<> >(4);
+  puts("balance: ok");
+  return 0;
+}
@@ -0,0 +1,148 @@
+//  BTree comparé à std::set
+//
+//  Des degrés minimaux de 2 et 3 font passer insertions et suppressions
+//  aléatoires par toutes les scissions, fusions et emprunts ; des tailles
+//  autour de 2B-1 clefs testent les bornes d'une racine pleine. rank,
+//  nth_element, min et le parcours symétrique doivent suivre std::set,
+//  aussi avec std::greater, et un Compare qui lève laisse l'arbre intact.
+
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "../btree.cpp" // "btree.cpp" désignerait ce fichier
+
+template <typename Tree, typename Set>
+static void check(const Tree& t, const Set& ref) {
+  assert(t.size() == ref.size());
+  std::vector<int> keys;
+  t.visitSym([&keys](int k) { keys.push_back(k); });
+  assert(keys == std::vector<int>(ref.begin(), ref.end()));
+  size_t i = 0;
+  for (int k : ref) {
+    assert(t.contains(k) && t.rank(k) == i && t.nth_element(i) == k);
+    ++i;
+  }
+  if (!ref.empty()) assert(t.min() == *ref.begin());
+  bool thrown = false;
+  try { t.nth_element(ref.size()); }
+  catch (std::out_of_range&) { thrown = true; }
+  assert(thrown);
+}
+
+template <size_t B, typename Compare>
+static void randomOps(unsigned seed) {
+  BTree<int, B, Compare> t;
+  std::set<int, Compare> ref;
+  std::mt19937 g(seed);
+  for (int i = 0; i < 20000; ++i) {
+    int k = int(g() % 600);
+    switch (g() % 4) {
+    case 0:
+    case 1:
+      t.insert(k);
+      ref.insert(k);
+      break;
+    case 2:
+      assert(t.deleteElement(k) == (ref.erase(k) == 1));
+      assert(t.rank(k) == size_t(-1) && !t.contains(k));
+      break;
+    default:
+      if (!ref.empty()) {
+        t.deleteMin();
+        ref.erase(ref.begin());
+      }
+    }
+    if (i % 1000 == 0) check(t, ref);
+  }
+  check(t, ref);
+  BTree<int, B, Compare> copy(t);
+  const std::set<int, Compare> saved(ref);
+  check(copy, saved);
+  while (!ref.empty()) {
+    int k = *std::next(ref.begin(), long(g() % ref.size()));
+    assert(t.deleteElement(k));
+    ref.erase(k);
+  }
+  check(t, ref);
+  assert(!t.deleteElement(0));
+  check(copy, saved);
+}
+
+// tailles autour de celle d'une racine pleine et de ses deux scissions
+template <size_t B>
+static void splitSizes() {
+  const size_t sizes[] = {1, 2 * B - 2, 2 * B - 1, 2 * B, 4 * B - 1, 4 * B, 6 * B};
+  for (size_t n : sizes) {
+    BTree<int, B> up, down;
+    std::set<int> ref;
+    for (size_t i = 0; i < n; ++i) {
+      up.insert(int(i));
+      down.insert(int(n - i));
+      ref.insert(int(i));
+    }
+    check(up, ref);
+    for (size_t i = 0; i < n; ++i) assert(down.nth_element(i) == int(i + 1));
+    for (size_t i = 0; i < n; ++i) {
+      assert(up.deleteElement(int(n - 1 - i)) && up.size() == n - 1 - i);
+      ref.erase(int(n - 1 - i));
+      check(up, ref);
+    }
+  }
+}
+
+static int countdown = -1; // la comparaison numéro countdown lève
+
+struct ThrowingLess {
+  bool operator()(int a, int b) const {
+    if (countdown >= 0 && countdown-- == 0) throw std::runtime_error("comparaison");
+    return a < b;
+  }
+};
+
+static void throwingCompare() {
+  typedef BTree<int, 2, ThrowingLess> Tree;
+  static_assert(!noexcept(std::declval<Tree&>().deleteElement(0)),
+                "deleteElement transmet les exceptions de Compare");
+  static_assert(noexcept(std::declval<BTree<int, 2, std::greater<int> >&>().contains(0)) ==
+                noexcept(std::greater<int>()(0, 0)), "noexcept suit Compare");
+  Tree t;
+  std::set<int> ref;
+  for (int i = 0; i < 200; ++i) {
+    t.insert(i);
+    ref.insert(i);
+  }
+  for (int k = 0; k < 200; k += 3) {
+    for (int c = 0;; ++c) {
+      countdown = c;
+      try {
+        bool erased = t.deleteElement(k);
+        countdown = -1;
+        assert(erased);
+        ref.erase(k);
+        break;
+      } catch (std::runtime_error&) {
+        countdown = -1;
+        check(t, ref);
+      }
+    }
+  }
+  check(t, ref);
+}
+
+int main() {
+  randomOps<2, std::less<int> >(1);
+  randomOps<3, std::less<int> >(2);
+  randomOps<16, std::less<int> >(3);
+  randomOps<2, std::greater<int> >(4);
+  splitSizes<2>();
+  splitSizes<3>();
+  splitSizes<16>();
+  throwingCompare();
+  puts("btree: ok");
+  return 0;
+}
@@ -0,0 +1,88 @@
+//  ConcurrentSearchTree : écritures simultanées et lectures sans verrou
+//
+//  Chaque écrivain insère et supprime au hasard ses propres clefs en
+//  tenant la liste de celles qui restent, pendant que des lecteurs
+//  cherchent des clefs jamais supprimées : une restructuration en cours ne
+//  doit pas les leur cacher. Une fois les threads terminés, contenu,
+//  tailles, rangs et positions doivent correspondre exactement.
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "concurrent_search_tree.cpp"
+
+static const int WRITERS = 4;
+static const int READERS = 2;
+static const int KEYS = 4000; // clefs d'écrivain : k % WRITERS désigne l'écrivain
+
+// clefs permanentes, impaires, entre les clefs paires des écrivains
+static int permanent(int i) {
+  return 2 * i + 1;
+}
+
+static bool outOfRange(const ConcurrentSearchTree<int>& t, size_t n) {
+  try { t.nth_element(n); }
+  catch (std::out_of_range&) { return true; }
+  return false;
+}
+
+int main() {
+  ConcurrentSearchTree<int> t;
+  assert(t.size() == 0 && !t.contains(0) && outOfRange(t, 0));
+  for (int i = 0; i < KEYS; i += 7) t.insert(permanent(i));
+  size_t permanents = t.size();
+
+  std::vector<std::set<int> > kept(WRITERS);
+  std::atomic<int> running(WRITERS);
+  std::atomic<bool> missed(false);
+  std::vector<std::thread> pool;
+  for (int w = 0; w < WRITERS; ++w) {
+    pool.emplace_back([&t, &kept, &running, w] {
+      std::mt19937 g(unsigned(w + 1));
+      std::set<int>& mine = kept[size_t(w)];
+      for (int i = 0; i < 20000; ++i) {
+        int k = 2 * (int(g() % (KEYS / WRITERS)) * WRITERS + w);
+        if (g() % 3) {
+          t.insert(k);
+          mine.insert(k);
+        } else {
+          assert(t.deleteElement(k) == (mine.erase(k) == 1));
+        }
+      }
+      --running;
+    });
+  }
+  for (int r = 0; r < READERS; ++r) {
+    pool.emplace_back([&t, &running, &missed, permanents, r] {
+      std::mt19937 g(unsigned(100 + r));
+      while (running.load() > 0) {
+        int k = permanent(int(g() % (KEYS / 7)) * 7);
+        if (!t.contains(k) || t.rank(k) == size_t(-1)) missed = true;
+        t.nth_element(g() % permanents);
+      }
+    });
+  }
+  for (std::thread& th : pool) th.join();
+  assert(!missed);
+
+  std::set<int> expected;
+  for (int i = 0; i < KEYS; i += 7) expected.insert(permanent(i));
+  for (const std::set<int>& mine : kept) expected.insert(mine.begin(), mine.end());
+  assert(t.size() == expected.size() && outOfRange(t, expected.size()));
+  size_t i = 0;
+  for (int k : expected) {
+    assert(t.contains(k) && t.rank(k) == i && t.nth_element(i) == k);
+    ++i;
+  }
+  assert(t.min() == *expected.begin());
+  for (int k = 0; k < 2 * KEYS; k += 2)
+    if (!expected.count(k)) assert(!t.contains(k) && t.rank(k) == size_t(-1));
+
+  puts("concurrent: ok");
+  return 0;
+}
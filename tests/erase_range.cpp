@@ -0,0 +1,124 @@
+//  erase_range, erase_ranks, split et recherches avec un Compare qui lève
+//
+//  Les comparaisons d'erase_range et de split sont faites avant toute
+//  modification : une exception de Compare doit laisser l'arbre intact,
+//  au lieu d'interrompre une restructuration. contains, rank,
+//  deleteElement et count_in_range doivent la transmettre à l'appelant.
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+static int countdown = -1; // la comparaison numéro countdown lève
+
+struct ThrowingLess {
+  bool operator()(int a, int b) const {
+    if (countdown >= 0 && countdown-- == 0) throw std::runtime_error("comparaison");
+    return a < b;
+  }
+};
+
+struct NothrowLess {
+  bool operator()(int a, int b) const noexcept { return a < b; }
+};
+
+template <typename Tree>
+static void checkUnchanged(const Tree& t, size_t n) {
+  assert(t.size() == n);
+  int i = 0;
+  for (int k : t) assert(k == i++);
+  for (size_t r = 0; r < n; ++r) assert(t.rank(int(r)) == r);
+}
+
+template <typename Balance>
+static void run() {
+  typedef BinarySearchTree<int, Balance, std::allocator<int>, NoTrace, ThrowingLess> Tree;
+  static_assert(!noexcept(std::declval<Tree&>().erase_range(0, 1)),
+                "erase_range ne peut être noexcept avec un Compare qui lève");
+  const size_t n = 500;
+  std::vector<int> keys;
+  for (size_t i = 0; i < n; ++i) keys.push_back(int(i));
+  Tree t(keys.begin(), keys.end());
+
+  // chaque comparaison de split puis d'erase_range lève à son tour,
+  // jusqu'à ce que l'opération aboutisse
+  for (int c = 0;; ++c) {
+    countdown = c;
+    try {
+      std::pair<Tree, Tree> p = t.split(250);
+      countdown = -1;
+      assert(p.first.size() == 250 && p.second.size() == n - 250);
+      t = Tree::join(std::move(p.first), std::move(p.second));
+      break;
+    } catch (std::runtime_error&) {
+      countdown = -1;
+      checkUnchanged(t, n);
+    }
+  }
+  for (int c = 0;; ++c) {
+    countdown = c;
+    try {
+      size_t erased = t.erase_range(100, 200);
+      countdown = -1;
+      assert(erased == 100);
+      break;
+    } catch (std::runtime_error&) {
+      countdown = -1;
+      checkUnchanged(t, n);
+    }
+  }
+  assert(t.size() == n - 100);
+  assert(!t.contains(100) && !t.contains(199) && t.contains(99) && t.contains(200));
+  assert(t.erase_ranks(0, 10) == 10 && t.nth_element(0) == 10);
+}
+
+// chaque recherche lève à sa première comparaison et laisse l'arbre intact
+template <typename Balance>
+static void lookups() {
+  typedef BinarySearchTree<int, Balance, std::allocator<int>, NoTrace, ThrowingLess> Tree;
+  typedef BinarySearchTree<int, Balance, std::allocator<int>, NoTrace, NothrowLess> Safe;
+  static_assert(!noexcept(std::declval<Tree&>().contains(0)) &&
+                !noexcept(std::declval<Tree&>().rank(0)) &&
+                !noexcept(std::declval<Tree&>().deleteElement(0)) &&
+                !noexcept(std::declval<Tree&>().count_in_range(0, 1)),
+                "les recherches transmettent les exceptions de Compare");
+  static_assert(noexcept(std::declval<Safe&>().contains(0)) &&
+                noexcept(std::declval<Safe&>().rank(0)) &&
+                noexcept(std::declval<Safe&>().deleteElement(0)) &&
+                noexcept(std::declval<Safe&>().count_in_range(0, 1)),
+                "un Compare noexcept garde des recherches noexcept");
+  const size_t n = 100;
+  Tree t;
+  for (size_t i = 0; i < n; ++i) t.insert(int(i));
+  int thrown = 0;
+  for (int op = 0; op < 4; ++op) {
+    countdown = 0;
+    try {
+      if (op == 0) t.contains(50);
+      else if (op == 1) t.rank(50);
+      else if (op == 2) t.deleteElement(50);
+      else t.count_in_range(10, 20);
+    } catch (std::runtime_error&) {
+      ++thrown;
+    }
+    countdown = -1;
+    checkUnchanged(t, n);
+  }
+  assert(thrown == 4);
+}
+
+int main() {
+  run<NoBalance>();
+  run<AvlBalance>();
+  run<RedBlackBalance>();
+  run<ScapegoatBalance<> >();
+  lookups<NoBalance>();
+  lookups<AvlBalance>();
+  lookups<RedBlackBalance>();
+  lookups<ScapegoatBalance<> >();
+  puts("erase_range: ok");
+  return 0;
+}
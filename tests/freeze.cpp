@@ -0,0 +1,51 @@
+//  freeze() d'arbres ordonnés par un Compare autre que std::less
+//
+//  L'image figée doit garder l'ordre de l'arbre : mêmes rangs, mêmes
+//  clefs en position n et recherches menées selon le même Compare.
+
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+template <typename Tree>
+static void check(const Tree& t, const std::vector<typename Tree::value_type>& absent) {
+  auto f = t.freeze();
+  assert(f.size() == t.size());
+  for (size_t i = 0; i < t.size(); ++i) {
+    const typename Tree::value_type& k = t.nth_element(i);
+    assert(f.nth_element(i) == k);
+    assert(f.rank(k) == i && f.count_less(k) == i && f.contains(k));
+    assert(f.lower_bound(k) && *f.lower_bound(k) == k);
+  }
+  std::vector<char> found(absent.size());
+  f.contains(absent.begin(), absent.end(), found.begin());
+  for (size_t i = 0; i < absent.size(); ++i) {
+    assert(!f.contains(absent[i]) && !found[i]);
+    assert(f.count_less(absent[i]) == t.count_less(absent[i]));
+  }
+}
+
+int main() {
+  BinarySearchTree<int, AvlBalance, std::allocator<int>, NoTrace, std::greater<int> > down;
+  std::vector<int> odd;
+  for (int i = 0; i < 1000; ++i) {
+    down.insert(2 * i);
+    odd.push_back(2 * i + 1);
+  }
+  odd.push_back(-1);
+  check(down, odd);
+  assert(down.freeze().nth_element(0) == 1998);
+
+  BinarySearchTree<std::string, RedBlackBalance, std::allocator<std::string>, NoTrace,
+                   std::greater<> > words;
+  const char* w[] = {"pomme", "abricot", "kiwi", "banane", "zeste", "figue"};
+  for (const char* s : w) words.insert(s);
+  check(words, std::vector<std::string>{"", "cerise", "zzz"});
+  assert(words.freeze().nth_element(0) == "zeste");
+
+  puts("freeze: ok");
+  return 0;
+}
@@ -0,0 +1,108 @@
+//  const_iterator, find, lower_bound et upper_bound comparés à std::set
+//
+//  Le parcours dans les deux sens, --end(), l'aller-retour ++ puis -- depuis
+//  chaque position et les itérateurs rendus par les recherches doivent
+//  désigner les mêmes clefs que ceux de std::set. Un arbre sans équilibrage
+//  rempli par clefs croissantes puis décroissantes a des chemins bien plus
+//  longs que la partie rangée dans l'itérateur : ses copies doivent rester
+//  indépendantes.
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+template <typename Tree>
+static void check(const Tree& t, const std::set<int>& ref) {
+  assert(std::equal(t.begin(), t.end(), ref.begin(), ref.end()));
+  assert(std::equal(t.rbegin(), t.rend(), ref.rbegin(), ref.rend()));
+  assert(size_t(std::distance(t.begin(), t.end())) == ref.size());
+  if (ref.empty()) {
+    assert(t.begin() == t.end() && t.find(0) == t.end());
+    return;
+  }
+  assert(*--t.end() == *ref.rbegin() && *t.begin() == *ref.begin());
+
+  // aller-retour depuis chaque position, copies comprises
+  for (typename Tree::const_iterator it = t.begin(); it != t.end(); ++it) {
+    typename Tree::const_iterator copy = it;
+    assert(--++copy == it && *copy == *it);
+    if (it != t.begin()) assert(++--copy == it);
+    typename Tree::const_iterator next = copy++;
+    assert(next == it && std::next(it) == copy);
+  }
+
+  // clefs présentes, absentes et hors de l'intervalle
+  int lo = *ref.begin() - 2, hi = *ref.rbegin() + 2;
+  for (int k = lo; k <= hi; ++k) {
+    typename Tree::const_iterator f = t.find(k);
+    assert(ref.count(k) ? f != t.end() && *f == k : f == t.end());
+    std::set<int>::const_iterator l = ref.lower_bound(k), u = ref.upper_bound(k);
+    typename Tree::const_iterator tl = t.lower_bound(k), tu = t.upper_bound(k);
+    assert(l == ref.end() ? tl == t.end() : tl != t.end() && *tl == *l);
+    assert(u == ref.end() ? tu == t.end() : tu != t.end() && *tu == *u);
+    assert(t.equal_range(k) == std::make_pair(tl, tu));
+    assert(size_t(std::distance(t.begin(), tl)) == size_t(std::distance(ref.begin(), l)));
+    if (tl != t.begin()) assert(*std::prev(tl) == *std::prev(l));
+  }
+}
+
+template <typename Balance>
+static void run(unsigned seed) {
+  BinarySearchTree<int, Balance> t;
+  std::set<int> ref;
+  check(t, ref);
+  t.insert(7);
+  ref.insert(7);
+  check(t, ref);
+  std::mt19937 g(seed);
+  for (int i = 0; i < 3000; ++i) {
+    int k = 2 * int(g() % 1000);
+    if (g() % 3) {
+      t.insert(k);
+      ref.insert(k);
+    } else {
+      t.deleteElement(k);
+      ref.erase(k);
+    }
+    if (i % 500 == 0) check(t, ref);
+  }
+  check(t, ref);
+}
+
+// arbre dégénéré : l'ascendance du minimum dépasse largement 32 noeuds
+static void deep() {
+  BinarySearchTree<int> t;
+  std::set<int> ref;
+  for (int i = 0; i < 100; ++i) {
+    t.insert(1000 + i);
+    t.insert(999 - i);
+    ref.insert(1000 + i);
+    ref.insert(999 - i);
+  }
+  assert(t.stats().height > 64);
+  check(t, ref);
+
+  std::vector<BinarySearchTree<int>::const_iterator> its;
+  for (BinarySearchTree<int>::const_iterator it = t.begin(); it != t.end(); ++it) its.push_back(it);
+  std::vector<BinarySearchTree<int>::const_iterator> copies(its);
+  for (BinarySearchTree<int>::const_iterator& it : its) ++it;
+  std::set<int>::const_iterator r = ref.begin();
+  for (size_t i = 0; i < copies.size(); ++i, ++r) {
+    assert(*copies[i] == *r && --its[i] == copies[i]);
+  }
+}
+
+int main() {
+  run<NoBalance>(1);
+  run<AvlBalance>(2);
+  run<RedBlackBalance>(3);
+  run<ScapegoatBalance<> >(4);
+  deep();
+  puts("iterator: ok");
+  return 0;
+}
@@ -0,0 +1,83 @@
+//  BinarySearchMap : accès par position et agrégats après modification
+//
+//  nth_element doit lever std::out_of_range dès que n >= size(), et les
+//  sommes par intervalle doivent suivre update, insert_or_assign et erase.
+//  erase, contains et rank transmettent les exceptions d'un Compare qui
+//  lève, et restent noexcept avec un Compare qui ne lève pas.
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "binary_search_map.cpp"
+
+static bool failing = false;
+
+struct ThrowingLess {
+  bool operator()(int a, int b) const {
+    if (failing) throw std::runtime_error("comparaison");
+    return a < b;
+  }
+};
+
+struct NothrowLess {
+  bool operator()(int a, int b) const noexcept { return a < b; }
+};
+
+template <typename Map>
+static bool outOfRange(const Map& m, size_t n) {
+  try { m.nth_element(n); }
+  catch (std::out_of_range&) { return true; }
+  return false;
+}
+
+int main() {
+  BinarySearchMap<int, long, SumMonoid<long> > m;
+  assert(outOfRange(m, 0));
+  for (int i = 0; i < 100; ++i) m.insert(i, long(i));
+  assert(m.nth_element(99).key() == 99);
+  assert(outOfRange(m, 100) && outOfRange(m, 1000));
+
+  assert(m.aggregate() == 4950 && m.aggregate(10, 20) == 145);
+  assert(m.update(15, [](long& v) { v += 1000; }));
+  assert(!m.update(500, [](long& v) { v = 0; }));
+  assert(m.aggregate(10, 20) == 1145 && m.at(15) == 1015);
+  assert(!m.insert_or_assign(15, 15L) && m.insert_or_assign(200, 7L));
+  assert(m.erase(0) && m.erase(99));
+  assert(m.aggregate() == 4950 - 99 + 7 && m.size() == 99);
+  assert(outOfRange(m, 99) && m.nth_element(98).key() == 200);
+
+  BinarySearchMap<std::string, std::string> words;
+  assert(words.try_emplace("kiwi", 3, 'k') && !words.try_emplace("kiwi", "x"));
+  assert(words.at("kiwi") == "kkk" && outOfRange(words, 1));
+
+  typedef BinarySearchMap<int, int, void, RedBlackBalance, ThrowingLess> Throwing;
+  typedef BinarySearchMap<int, int, void, RedBlackBalance, NothrowLess> Safe;
+  static_assert(!noexcept(std::declval<Throwing&>().erase(0)) &&
+                !noexcept(std::declval<Throwing&>().contains(0)) &&
+                !noexcept(std::declval<Throwing&>().rank(0)),
+                "les recherches transmettent les exceptions de Compare");
+  static_assert(noexcept(std::declval<Safe&>().erase(0)) &&
+                noexcept(std::declval<Safe&>().contains(0)) &&
+                noexcept(std::declval<Safe&>().rank(0)),
+                "un Compare noexcept garde des recherches noexcept");
+  Throwing t;
+  for (int i = 0; i < 20; ++i) t.insert(i, i);
+  int thrown = 0;
+  for (int op = 0; op < 3; ++op) {
+    failing = true;
+    try {
+      if (op == 0) t.erase(5);
+      else if (op == 1) t.contains(5);
+      else t.rank(5);
+    } catch (std::runtime_error&) {
+      ++thrown;
+    }
+    failing = false;
+  }
+  assert(thrown == 3 && t.size() == 20 && t.contains(5) && t.rank(5) == 5);
+
+  puts("map: ok");
+  return 0;
+}
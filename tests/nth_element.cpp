@@ -0,0 +1,38 @@
+//  nth_element et rank aux bornes
+//
+//  Les positions vont de 0 à size()-1 : nth_element doit lever
+//  std::out_of_range sur un arbre vide et dès que n >= size(), sans
+//  descendre dans l'arbre, quelle que soit la politique d'équilibrage.
+
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include "binary_search_tree.cpp"
+
+template <typename Tree>
+static bool outOfRange(const Tree& t, size_t n) {
+  try { t.nth_element(n); }
+  catch (std::out_of_range&) { return true; }
+  return false;
+}
+
+template <typename Balance>
+static void run() {
+  BinarySearchTree<int, Balance> t;
+  assert(outOfRange(t, 0) && outOfRange(t, size_t(-1)));
+  for (int i = 0; i < 10; ++i) t.insert(i * 10);
+  for (size_t i = 0; i < 10; ++i) assert(t.nth_element(i) == int(i) * 10 && t.rank(int(i) * 10) == i);
+  assert(outOfRange(t, 10) && outOfRange(t, 11) && outOfRange(t, size_t(-1)));
+  assert(t.rank(5) == size_t(-1));
+  t.clear();
+  assert(outOfRange(t, 0));
+}
+
+int main() {
+  run<NoBalance>();
+  run<AvlBalance>();
+  run<RedBlackBalance>();
+  run<ScapegoatBalance<> >();
+  puts("nth_element: ok");
+  return 0;
+}
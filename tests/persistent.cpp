@@ -0,0 +1,92 @@
+//  PersistentSearchTree : versions indépendantes, Compare et parcours
+//
+//  Compare les trois parcours itératifs à ceux de BinarySearchTree, vérifie
+//  qu'une modification n'affecte pas les copies antérieures et qu'un arbre
+//  ordonné par std::greater garde cet ordre.
+
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+#include "binary_search_tree.cpp"
+#include "persistent_search_tree.cpp"
+
+template <typename Tree>
+static std::vector<int> pre(const Tree& t) {
+  std::vector<int> v;
+  t.visitPre([&v](int k) { v.push_back(k); });
+  return v;
+}
+
+template <typename Tree>
+static std::vector<int> sym(const Tree& t) {
+  std::vector<int> v;
+  t.visitSym([&v](int k) { v.push_back(k); });
+  return v;
+}
+
+template <typename Tree>
+static std::vector<int> post(const Tree& t) {
+  std::vector<int> v;
+  t.visitPost([&v](int k) { v.push_back(k); });
+  return v;
+}
+
+// vérifie que les trois parcours décrivent le même arbre : la racine d'un
+// sous-arbre de n clefs est en tête de son pré-ordre et en fin de son
+// post-ordre, sa position dans le parcours symétrique donne la taille de
+// son sous-arbre gauche
+static void checkTraversals(const std::vector<int>& p, const std::vector<int>& s,
+                            const std::vector<int>& q, size_t pi, size_t si, size_t qi,
+                            size_t n) {
+  if (n == 0) return;
+  int root = p[pi];
+  assert(q[qi + n - 1] == root);
+  size_t nl = 0;
+  while (s[si + nl] != root) ++nl;
+  checkTraversals(p, s, q, pi + 1, si, qi, nl);
+  checkTraversals(p, s, q, pi + 1 + nl, si + nl + 1, qi + nl, n - nl - 1);
+}
+
+template <typename Compare>
+static void run() {
+  typedef PersistentSearchTree<int, Compare> Tree;
+  std::mt19937 g(3);
+  Tree t;
+  std::vector<Tree> versions;
+  std::vector<std::vector<int> > contents;
+  BinarySearchTree<int, AvlBalance, std::allocator<int>, NoTrace, Compare> ref;
+  for (int i = 0; i < 2000; ++i) {
+    int k = int(g() % 1000);
+    if (g() % 3) {
+      t.insert(k);
+      ref.insert(k);
+    } else {
+      assert(t.deleteElement(k) == ref.deleteElement(k));
+    }
+    if (i % 200 == 0) {
+      versions.push_back(t.snapshot());
+      contents.push_back(sym(t));
+    }
+  }
+  assert(sym(t) == std::vector<int>(ref.begin(), ref.end()));
+  for (size_t i = 0; i < t.size(); ++i) {
+    assert(t.nth_element(i) == ref.nth_element(i) && t.rank(t.nth_element(i)) == i);
+  }
+  std::vector<int> p = pre(t), s = sym(t), q = post(t);
+  assert(p.size() == t.size() && q.size() == t.size());
+  checkTraversals(p, s, q, 0, 0, 0, s.size());
+
+  for (size_t v = 0; v < versions.size(); ++v) assert(sym(versions[v]) == contents[v]);
+}
+
+int main() {
+  run<std::less<int> >();
+  run<std::greater<int> >();
+  PersistentSearchTree<int, std::greater<int> > down;
+  for (int i = 0; i < 10; ++i) down.insert(i);
+  assert(down.min() == 9 && down.nth_element(9) == 0 && down.rank(7) == 2);
+  puts("persistent: ok");
+  return 0;
+}
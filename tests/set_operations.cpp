@@ -0,0 +1,96 @@
+//  set_union, set_intersection et set_difference
+//
+//  Compare les opérations ensemblistes, en copie et par déplacement, aux
+//  algorithmes de la bibliothèque standard, sur un arbre simple et sur un
+//  arbre augmenté d'une somme par sous-arbre dont l'agrégat doit rester
+//  exact.
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "binary_search_tree.cpp"
+
+template <typename Tree>
+static std::vector<int> keys(const Tree& t) {
+  return std::vector<int>(t.begin(), t.end());
+}
+
+template <typename Tree>
+static void check(const Tree& t, const std::vector<int>& expected) {
+  assert(keys(t) == expected);
+  for (size_t i = 0; i < t.size(); ++i) assert(t.rank(t.nth_element(i)) == i);
+}
+
+template <typename Tree>
+static long sum(const Tree& t) {
+  long s = 0;
+  for (int k : t) s += k;
+  return s;
+}
+
+// agrégat de l'arbre augmenté, comparé à la somme de ses clefs
+template <typename Tree>
+static auto checkAggregate(const Tree& t, int) -> decltype(t.aggregate(), void()) {
+  assert(t.aggregate() == sum(t));
+}
+
+template <typename Tree>
+static void checkAggregate(const Tree&, long) {
+}
+
+template <typename Tree>
+static void run(size_t n, size_t m) {
+  std::mt19937 g(unsigned(n * 31 + m));
+  std::vector<int> va, vb;
+  for (size_t i = 0; i < n; ++i) va.push_back(int(g() % (2 * (n + m))));
+  for (size_t i = 0; i < m; ++i) vb.push_back(int(g() % (2 * (n + m))));
+  Tree a(va.begin(), va.end()), b(vb.begin(), vb.end());
+  std::vector<int> ka = keys(a), kb = keys(b), expected;
+
+  std::set_union(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(expected));
+  Tree u = set_union(a, b);
+  check(u, expected);
+  checkAggregate(u, 0);
+  Tree um = set_union(Tree(a), Tree(b));
+  check(um, expected);
+  checkAggregate(um, 0);
+
+  expected.clear();
+  std::set_intersection(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(expected));
+  Tree i = set_intersection(a, b);
+  check(i, expected);
+  checkAggregate(i, 0);
+  Tree im = set_intersection(Tree(a), b);
+  check(im, expected);
+  checkAggregate(im, 0);
+
+  expected.clear();
+  std::set_difference(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(expected));
+  Tree d = set_difference(a, b);
+  check(d, expected);
+  checkAggregate(d, 0);
+  Tree dm = set_difference(Tree(a), b);
+  check(dm, expected);
+  checkAggregate(dm, 0);
+}
+
+template <typename Tree>
+static void runSizes() {
+  const size_t sizes[] = {0, 1, 10, 100, 2000};
+  for (size_t n : sizes)
+    for (size_t m : sizes) run<Tree>(n, m);
+}
+
+int main() {
+  runSizes<BinarySearchTree<int, AvlBalance> >();
+  runSizes<BinarySearchTree<int, RedBlackBalance> >();
+  runSizes<BinarySearchTree<int, AvlBalance, std::allocator<int>, NoTrace, std::less<int>,
+                            MonoidAugment<SumMonoid<long> > > >();
+  runSizes<BinarySearchTree<int, RedBlackBalance, std::allocator<int>, NoTrace, std::less<int>,
+                            MonoidAugment<SumMonoid<long> > > >();
+  puts("set_operations: ok");
+  return 0;
+}
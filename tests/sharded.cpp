@@ -0,0 +1,148 @@
+//  ShardedSearchTree : répartition, rangs globaux et écritures simultanées
+//
+//  Des insertions croissantes remplissent toujours le dernier fragment et
+//  déclenchent des répartitions automatiques ; rebalance() en force
+//  d'autres, y compris avec moins de clefs que de fragments. Après chacune,
+//  size, contains, rank et nth_element doivent suivre un vecteur trié des
+//  clefs. Des écrivains insèrent et suppriment ensuite leurs propres clefs
+//  pendant qu'un autre thread répartit sans cesse et que des lecteurs
+//  cherchent des clefs jamais supprimées.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "sharded_search_tree.cpp"
+
+static bool outOfRange(const ShardedSearchTree<int>& t, size_t n) {
+  try { t.nth_element(n); }
+  catch (std::out_of_range&) { return true; }
+  return false;
+}
+
+// keys contient les clefs attendues, triées ; les entiers de -1 à
+// 2 * max + 1 absents de keys ne doivent pas être trouvés
+static void check(const ShardedSearchTree<int>& t, const std::vector<int>& keys) {
+  assert(t.size() == keys.size() && outOfRange(t, keys.size()));
+  for (size_t i = 0; i < keys.size(); ++i)
+    assert(t.contains(keys[i]) && t.rank(keys[i]) == i && t.nth_element(i) == keys[i]);
+  int last = keys.empty() ? 0 : keys.back();
+  for (int k = -1; k <= 2 * last + 1; ++k)
+    if (!std::binary_search(keys.begin(), keys.end(), k)) assert(!t.contains(k) && t.rank(k) == size_t(-1));
+}
+
+static void sequential() {
+  ShardedSearchTree<int> t(8, 16);
+  std::vector<int> keys;
+  check(t, keys);
+  t.rebalance();
+  check(t, keys);
+
+  // moins de clefs que de fragments : toutes restent dans le premier
+  for (int i = 0; i < 5; ++i) {
+    t.insert(2 * i);
+    keys.push_back(2 * i);
+  }
+  t.rebalance();
+  check(t, keys);
+
+  // croissantes : le dernier fragment grossit jusqu'à une répartition
+  for (int i = 5; i < 2000; ++i) {
+    t.insert(2 * i);
+    keys.push_back(2 * i);
+    if (i % 97 == 0) check(t, keys);
+  }
+  check(t, keys);
+  t.insert(2 * 1000);
+  check(t, keys);
+
+  // suppressions aléatoires vidant des fragments entiers, puis répartition
+  std::mt19937 g(1);
+  std::shuffle(keys.begin(), keys.end(), g);
+  for (size_t i = 0; i < 1500; ++i) assert(t.deleteElement(keys[i]) && !t.deleteElement(keys[i]));
+  keys.erase(keys.begin(), keys.begin() + 1500);
+  std::sort(keys.begin(), keys.end());
+  check(t, keys);
+  t.rebalance();
+  check(t, keys);
+
+  // décroissantes : le premier fragment grossit à son tour
+  for (int i = 0; i < 500; ++i) {
+    t.insert(-2 * i - 2);
+    keys.insert(keys.begin(), -2 * i - 2);
+  }
+  assert(t.nth_element(0) == -1000 && t.rank(-1000) == 0);
+  check(t, keys);
+  t.rebalance();
+  check(t, keys);
+}
+
+static const int WRITERS = 4;
+static const int READERS = 2;
+static const int KEYS = 4000; // clefs d'écrivain : k % WRITERS désigne l'écrivain
+
+// clefs permanentes, impaires, entre les clefs paires des écrivains
+static int permanent(int i) {
+  return 2 * i + 1;
+}
+
+static void concurrent() {
+  ShardedSearchTree<int> t(4, 32);
+  for (int i = 0; i < KEYS; i += 7) t.insert(permanent(i));
+  size_t permanents = t.size();
+
+  std::vector<std::set<int> > kept(WRITERS);
+  std::atomic<int> running(WRITERS);
+  std::atomic<bool> missed(false);
+  std::vector<std::thread> pool;
+  for (int w = 0; w < WRITERS; ++w) {
+    pool.emplace_back([&t, &kept, &running, w] {
+      std::mt19937 g(unsigned(w + 1));
+      std::set<int>& mine = kept[size_t(w)];
+      for (int i = 0; i < 20000; ++i) {
+        int k = 2 * (int(g() % (KEYS / WRITERS)) * WRITERS + w);
+        if (g() % 3) {
+          t.insert(k);
+          mine.insert(k);
+        } else {
+          assert(t.deleteElement(k) == (mine.erase(k) == 1));
+        }
+      }
+      --running;
+    });
+  }
+  pool.emplace_back([&t, &running] {
+    while (running.load() > 0) t.rebalance();
+  });
+  for (int r = 0; r < READERS; ++r) {
+    pool.emplace_back([&t, &running, &missed, permanents, r] {
+      std::mt19937 g(unsigned(100 + r));
+      while (running.load() > 0) {
+        int k = permanent(int(g() % (KEYS / 7)) * 7);
+        if (!t.contains(k) || t.rank(k) == size_t(-1)) missed = true;
+        t.nth_element(g() % permanents);
+      }
+    });
+  }
+  for (std::thread& th : pool) th.join();
+  assert(!missed);
+
+  std::set<int> expected;
+  for (int i = 0; i < KEYS; i += 7) expected.insert(permanent(i));
+  for (const std::set<int>& mine : kept) expected.insert(mine.begin(), mine.end());
+  check(t, std::vector<int>(expected.begin(), expected.end()));
+  t.rebalance();
+  check(t, std::vector<int>(expected.begin(), expected.end()));
+}
+
+int main() {
+  sequential();
+  concurrent();
+  puts("sharded: ok");
+  return 0;
+}
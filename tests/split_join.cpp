@@ -0,0 +1,93 @@
+//  split, split_at_rank et join avec un ArenaAllocator
+//
+//  Les morceaux d'un split gardent les noeuds de l'arbre d'origine : ils
+//  doivent partager son arène, pour que supprimer une clef d'un morceau,
+//  les réunir par join puis affecter le résultat à l'arbre d'origine
+//  rendent les noeuds à l'arène qui les a fournis.
+//
+//  Des jointures répétées d'un arbre d'une clef, puis des split et
+//  erase_range, doivent laisser un arbre équilibré de hauteur O(log(N)).
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include "binary_search_tree.cpp"
+
+template <typename Balance>
+static void run() {
+  typedef BinarySearchTree<int, Balance, ArenaAllocator<int> > Tree;
+
+  Tree t;
+  for (int i = 0; i < 100; ++i) t.insert(i);
+
+  std::pair<Tree, Tree> p = t.split(50);
+  assert(t.size() == 0 && p.first.size() == 50 && p.second.size() == 50);
+  assert(p.first.deleteElement(10) && p.second.deleteElement(60));
+  p.first.insert(-1);
+  t = Tree::join(std::move(p.first), std::move(p.second));
+  assert(t.size() == 99 && !t.contains(10) && !t.contains(60) && t.contains(-1));
+  assert(p.first.size() == 0 && p.second.size() == 0);
+
+  std::pair<Tree, Tree> q = t.split_at_rank(30);
+  assert(q.first.size() == 30 && q.second.size() == 69);
+  assert(q.first.nth_element(0) == -1 && q.second.nth_element(0) == 30);
+  q.second.erase_range(40, 80);
+  t = Tree::join(std::move(q.first), std::move(q.second));
+  assert(t.size() == 60 && !t.contains(79) && t.contains(80));
+  for (size_t i = 0; i < t.size(); ++i) assert(t.rank(t.nth_element(i)) == i);
+
+  // un arbre construit à part a sa propre arène : join recopie ses clefs
+  Tree low = t.split(40).first, high;
+  for (int i = 100; i < 110; ++i) high.insert(i);
+  Tree all = Tree::join(std::move(low), std::move(high));
+  assert(all.size() == 50 && all.contains(105) && !all.contains(80));
+}
+
+// hauteur au plus 3 log2(N) : les politiques équilibrées garantissent
+// 1.44, 2 et log(2)/log(4/3) = 2.41 log2(N)
+template <typename Tree>
+static void checkHeight(const Tree& t) {
+  assert(t.stats().height <= size_t(3 * std::log2(double(t.size()) + 1)) + 1);
+}
+
+template <typename Balance>
+static void joinOneByOne() {
+  typedef BinarySearchTree<int, Balance> Tree;
+  const int n = 4000;
+  Tree t;
+  for (int i = 0; i < n; ++i) {
+    Tree one;
+    one.insert(i);
+    t = Tree::join(std::move(t), std::move(one));
+  }
+  assert(t.size() == size_t(n) && t.contains(n - 1));
+  checkHeight(t);
+  for (int i = 0; i < n; ++i) {
+    Tree one;
+    one.insert(-i - 1);
+    t = Tree::join(std::move(one), std::move(t));
+  }
+  checkHeight(t);
+
+  std::pair<Tree, Tree> p = t.split(n / 3);
+  checkHeight(p.first);
+  checkHeight(p.second);
+  t = Tree::join(std::move(p.first), std::move(p.second));
+  t.erase_range(-n / 2, n / 2);
+  assert(t.size() == size_t(n));
+  checkHeight(t);
+  for (size_t i = 0; i < t.size(); ++i) assert(t.rank(t.nth_element(i)) == i);
+}
+
+int main() {
+  run<NoBalance>();
+  run<AvlBalance>();
+  run<RedBlackBalance>();
+  run<ScapegoatBalance<> >();
+  joinOneByOne<AvlBalance>();
+  joinOneByOne<RedBlackBalance>();
+  joinOneByOne<ScapegoatBalance<> >();
+  puts("split_join: ok");
+  return 0;
+}
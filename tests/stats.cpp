@@ -0,0 +1,45 @@
+//  Compteurs de BST_STATS
+//
+//  Chaque opération publique compte un appel dans sa sorte d'opération,
+//  et les noeuds qu'elle alloue. Une copie assez grande pour être faite en
+//  parallèle, sur une machine à plusieurs coeurs, doit compter tous ses
+//  noeuds, y compris ceux alloués par les threads de la réserve : avec
+//  l'opération Bulk du nouvel arbre si elle est appelée directement, avec
+//  celle de l'arbre appelant si elle fait partie d'une autre opération.
+
+#define BST_STATS
+
+#include <cassert>
+#include <cstdio>
+#include <utility>
+#include "binary_search_tree.cpp"
+
+typedef BinarySearchTree<int, RedBlackBalance> Tree;
+typedef Tree::Operation Operation;
+
+int main() {
+  Tree t;
+  const size_t n = 100000; // bien au-delà du seuil de la copie parallèle
+  for (size_t i = 0; i < n; ++i) t.insert(int(i));
+  Tree::OperationStats s = t.operation_stats(Operation::Insert);
+  assert(s.calls == n && s.allocations == n && s.comparisons > 0);
+  assert(t.contains(5) && t.operation_stats(Operation::Lookup).calls == 1);
+
+  Tree copy(t);
+  assert(copy.size() == n && copy.checkInvariants());
+  s = copy.operation_stats(Operation::Bulk);
+  assert(s.calls == 1 && s.allocations == n);
+  assert(t.operation_stats(Operation::Bulk).calls == 0);
+
+  // copie faite par une opération Bulk de l'arbre de destination
+  Tree target;
+  target = t;
+  assert(target.size() == n);
+  s = target.operation_stats(Operation::Bulk);
+  assert(s.calls == 1 && s.allocations == n);
+
+  t.reset_operation_stats();
+  assert(t.operation_stats(Operation::Insert).calls == 0);
+  puts("stats: ok");
+  return 0;
+}
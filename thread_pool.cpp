@@ -0,0 +1,320 @@
+/*
+ -----------------------------------------------------------------------------------
+ Laboratoire : 09
+ Fichier     : thread_pool.cpp
+ Auteur(s)   : Eric Bousbaa, Lucas Gianinetti, Cassandre Wojciechowski
+ Date        : 13 juin 2019
+ But         : Réserve de threads à vol de tâches, utilisée par les parcours
+               parallèles de l'arbre binaire de recherche.
+ Compilateur : - MinGW-gcc 6.3.0
+               - Apple LLVM version 9.0.0 (clang-900.0.39.2)
+ Remarques   : Chaque thread possède sa file de tâches. Il prend ses tâches
+               par la fin de sa file et, lorsqu'elle est vide, vole les
+               tâches des autres par le début de leur file.
+ -----------------------------------------------------------------------------------
+*/
+
+#ifndef THREAD_POOL_CPP
+#define THREAD_POOL_CPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  @brief Réserve de threads à vol de tâches.
+ */
+class WorkStealingPool
+{
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // une file par thread
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending;                // tâches en attente dans les files
+    std::atomic<size_t> next;                   // file de la prochaine tâche soumise
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stop;
+
+public:
+    /**
+     * @brief Démarre une réserve de threads
+     *
+     * @param threads: nombre de threads, au moins 1
+     */
+    explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency())
+            : pending(0), next(0), stop(false)
+    {
+        threads = std::max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            queues.emplace_back(new Queue);
+        }
+        try
+        {
+            for (size_t i = 0; i < threads; ++i)
+            {
+                workers.emplace_back(&WorkStealingPool::work, this, i);
+            }
+        }
+        catch (...)
+        {
+            shutdown();
+            throw;
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief Attend la fin des threads. Les tâches encore en file ne sont pas
+     *        exécutées.
+     */
+    ~WorkStealingPool()
+    {
+        shutdown();
+    }
+
+    /**
+     * @brief Réserve partagée, avec un thread par coeur
+     */
+    static WorkStealingPool &instance()
+    {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    size_t size() const noexcept
+    {
+        return workers.size();
+    }
+
+    /**
+     * @brief Soumet une tâche. Soumise depuis un thread de la réserve, elle
+     *        va dans sa propre file, sinon les files sont servies à tour de
+     *        rôle.
+     *
+     * @remark Complexité O(1)
+     */
+    void submit(std::function<void()> task)
+    {
+        size_t i = self();
+        if (i >= queues.size())
+        {
+            i = next++ % queues.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            ++pending;
+        }
+        try
+        {
+            std::lock_guard<std::mutex> lock(queues[i]->mutex);
+            queues[i]->tasks.push_back(std::move(task));
+        }
+        catch (...)
+        {
+            --pending;
+            throw;
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * @brief Exécute une tâche en attente, s'il y en a une. Permet à un thread
+     *        qui attend des tâches de participer à leur exécution.
+     *
+     * @return true si une tâche a été exécutée
+     */
+    bool runPending()
+    {
+        std::function<void()> task;
+        size_t i = self();
+        if (take(i < queues.size() ? i : next % queues.size(), task))
+        {
+            task();
+            return true;
+        }
+        return false;
+    }
+
+private:
+    // indice du thread courant dans la réserve, size_t(-1) hors de la réserve
+    size_t self() const noexcept
+    {
+        return current().first == this ? current().second : size_t(-1);
+    }
+
+    static std::pair<const WorkStealingPool *, size_t> &current() noexcept
+    {
+        static thread_local std::pair<const WorkStealingPool *, size_t> c(nullptr, 0);
+        return c;
+    }
+
+    /**
+     * @brief Prend une tâche à la fin de la file i ou, à défaut, vole la
+     *        première tâche d'une autre file
+     */
+    bool take(size_t i, std::function<void()> &task)
+    {
+        for (size_t k = 0; k < queues.size(); ++k)
+        {
+            Queue &q = *queues[(i + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty())
+            {
+                if (k == 0)
+                {
+                    task = std::move(q.tasks.back());
+                    q.tasks.pop_back();
+                }
+                else
+                {
+                    task = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                }
+                --pending;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t i)
+    {
+        current() = std::make_pair(this, i);
+        std::function<void()> task;
+        for (;;)
+        {
+            if (take(i, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stop || pending > 0; });
+            if (stop)
+            {
+                return;
+            }
+        }
+    }
+
+    void shutdown() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::thread &t : workers)
+        {
+            t.join();
+        }
+        workers.clear();
+    }
+};
+
+/**
+ *  @brief Groupe de tâches dont on attend la fin.
+ *
+ *  Le thread qui attend exécute lui-même des tâches en attente, un groupe
+ *  peut donc être attendu depuis une tâche de la réserve. La première
+ *  exception levée par une tâche est relancée par wait().
+ */
+class TaskGroup
+{
+    WorkStealingPool &pool;
+    std::atomic<size_t> running; // tâches soumises et non terminées
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+public:
+    explicit TaskGroup(WorkStealingPool &pool = WorkStealingPool::instance())
+            : pool(pool), running(0)
+    {
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    ~TaskGroup()
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /**
+     * @brief Soumet f à la réserve
+     */
+    template <typename Fn>
+    void run(Fn f)
+    {
+        ++running;
+        try
+        {
+            pool.submit([this, f]() mutable {
+                try
+                {
+                    f();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+                --running;
+            });
+        }
+        catch (...)
+        {
+            --running;
+            throw;
+        }
+    }
+
+    /**
+     * @brief Attend la fin de toutes les tâches soumises
+     *
+     * @exception La première exception levée par une tâche
+     */
+    void wait()
+    {
+        while (running > 0)
+        {
+            if (!pool.runPending())
+            {
+                std::this_thread::yield();
+            }
+        }
+        if (error)
+        {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+};
+
+#endif